@@ -0,0 +1,81 @@
+/*!
+ * @file batchTransfer.ino
+ * @brief 一次执行一组modbus读写事务(例如调试变频器时的一串参数读写)，事务之间只保留t3.5帧间隔，
+ * @n 每个事务的状态和耗时保存在结果数组中，出错后可选择停止或继续执行。
+ * @n connected table
+ * ---------------------------------------------------------------------------------------------------------------
+ * sensor pin |             MCU                | Leonardo/Mega2560/M0 |    UNO    | ESP8266 | ESP32 |  microbit  |
+ *     VCC    |            3.3V/5V             |        VCC           |    VCC    |   VCC   |  VCC  |     X      |
+ *     GND    |              GND               |        GND           |    GND    |   GND   |  GND  |     X      |
+ *     RX     |              TX                |     Serial1 RX1      |     5     |5/D6(TX) |  D2   |     X      |
+ *     TX     |              RX                |     Serial1 TX1      |     4     |4/D7(RX) |  D3   |     X      |
+ * ---------------------------------------------------------------------------------------------------------------
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include "DFRobot_RTU.h"
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+#include <SoftwareSerial.h>
+#endif
+
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+  SoftwareSerial mySerial(/*rx =*/4, /*tx =*/5);
+  DFRobot_RTU modbus(/*s =*/&mySerial);
+#else
+  DFRobot_RTU modbus(/*s =*/&Serial1);
+#endif
+
+uint16_t status[2];
+uint16_t params[4] = {500, 1500, 30, 30};
+uint16_t run = 1;
+uint8_t outputs = 0x05;
+
+DFRobot_RTU::sRtuTransaction_t list[] = {
+  {/*id =*/0x01, DFRobot_RTU::eCMD_READ_HOLDING,        /*reg =*/0x0000, /*num =*/2, status},
+  {/*id =*/0x01, DFRobot_RTU::eCMD_WRITE_MULTI_HOLDING, /*reg =*/0x0100, /*num =*/4, params},
+  {/*id =*/0x01, DFRobot_RTU::eCMD_WRITE_MULTI_COILS,   /*reg =*/0x0000, /*num =*/3, &outputs},
+  {/*id =*/0x01, DFRobot_RTU::eCMD_WRITE_HOLDING,       /*reg =*/0x0200, /*num =*/1, &run},
+};
+#define TRANSACTION_NUM (sizeof(list) / sizeof(list[0]))
+DFRobot_RTU::sRtuResult_t result[TRANSACTION_NUM];
+
+void setup() {
+  Serial.begin(115200);
+  while(!Serial){                                                     //Waiting for USB Serial COM port to open.
+  }
+
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+    mySerial.begin(9600);
+#elif defined(ESP32)
+  Serial1.begin(9600, SERIAL_8N1, /*rx =*/D3, /*tx =*/D2);
+#else
+  Serial1.begin(9600);
+#endif
+  modbus.setBaudrate(9600);                                           //The same baudrate as the serial port, for the t3.5 frame gap
+}
+
+void loop() {
+  uint32_t start = micros();
+  uint8_t ret = modbus.executeBatch(list, TRANSACTION_NUM, result, /*stopOnError =*/true);
+  uint32_t total = micros() - start;
+  for(uint8_t i = 0; i < TRANSACTION_NUM; i++){
+    Serial.print("transaction ");
+    Serial.print(i);
+    Serial.print(": status ");
+    Serial.print(result[i].status);
+    Serial.print(", ");
+    Serial.print(result[i].latency);
+    Serial.println("us");
+  }
+  Serial.print("batch: ");
+  Serial.print(ret);
+  Serial.print(", total ");
+  Serial.print(total);
+  Serial.println("us");
+  delay(2000);
+}
@@ -0,0 +1,69 @@
+/*!
+ * @file busSniffer.ino
+ * @brief 被动监听modbus总线(不发送任何数据)，按t3.5间隔将字节流切分成帧，并以二进制抓包格式从Serial输出。
+ * @n 抓包格式见DFRobot_RTU_Sniffer.h，可以保存为文件后在上位机上回放。
+ * @n 在ESP32上使用115200波特率监听时，建议调大串口接收缓冲区，并保证loop()中没有阻塞的代码。ESP32串口默认攒够FIFO阈值才交出数据，
+ * @n 长帧会被误切成两段，需要arduino-esp32 3.x的setRxFIFOFull(1)让每个字节立即交出。
+ * @n connected table
+ * ---------------------------------------------------------------------------------------------------------------
+ * sensor pin |             MCU                | Leonardo/Mega2560/M0 |    UNO    | ESP8266 | ESP32 |  microbit  |
+ *     VCC    |            3.3V/5V             |        VCC           |    VCC    |   VCC   |  VCC  |     X      |
+ *     GND    |              GND               |        GND           |    GND    |   GND   |  GND  |     X      |
+ *     RX     |              TX                |     Serial1 RX1      |     5     |5/D6(TX) |  D2   |     X      |
+ *     TX     |              RX                |     Serial1 TX1      |     4     |4/D7(RX) |  D3   |     X      |
+ * ---------------------------------------------------------------------------------------------------------------
+ * @note: 不支持Microbit。UNO和ESP8266使用SoftwareSerial，只能监听9600波特率的总线
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include "DFRobot_RTU_Sniffer.h"
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+#include <SoftwareSerial.h>
+#endif
+
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+#define BUS_BAUDRATE   9600                                           //SoftwareSerial can not follow a faster bus
+  SoftwareSerial mySerial(/*rx =*/4, /*tx =*/5);
+  DFRobot_RTU_Sniffer sniffer(/*s =*/&mySerial);
+#else
+#define BUS_BAUDRATE   115200
+  DFRobot_RTU_Sniffer sniffer(/*s =*/&Serial1);
+#endif
+
+void setup() {
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+  Serial.begin(115200);
+#else
+  Serial.begin(921600);
+#endif
+  while(!Serial){                                                     //Waiting for USB Serial COM port to open.
+  }
+
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+  mySerial.begin(BUS_BAUDRATE);
+#elif defined(ESP32)
+  Serial1.setRxBufferSize(1024);
+  Serial1.begin(BUS_BAUDRATE, SERIAL_8N1, /*rx =*/D3, /*tx =*/D2);
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 3)
+  //The UART hands the bytes over when 120 are in its FIFO by default, which looks like a gap in a long frame.
+  Serial1.setRxFIFOFull(1);
+  Serial1.setRxTimeout(1);
+#endif
+#else
+  Serial1.begin(BUS_BAUDRATE);
+#endif
+  sniffer.setBaudrate(BUS_BAUDRATE);
+  sniffer.writeCaptureHeader(&Serial);
+}
+
+void loop() {
+  sniffer.poll();
+  if(sniffer.available()){
+    sniffer.exportCapture(&Serial);
+  }
+}
@@ -0,0 +1,70 @@
+/*!
+ * @file changeReport.ino
+ * @brief 周期轮询modbus从机的一段保持寄存器，只在寄存器值的变化超过死区时才通过回调输出，减少下游的数据量。
+ * @n 寄存器101使用绝对死区5，寄存器102(int16_t)使用10%的百分比死区，其他寄存器任何变化都会输出。
+ * @n connected table
+ * ---------------------------------------------------------------------------------------------------------------
+ * sensor pin |             MCU                | Leonardo/Mega2560/M0 |    UNO    | ESP8266 | ESP32 |  microbit  |
+ *     VCC    |            3.3V/5V             |        VCC           |    VCC    |   VCC   |  VCC  |     X      |
+ *     GND    |              GND               |        GND           |    GND    |   GND   |  GND  |     X      |
+ *     RX     |              TX                |     Serial1 RX1      |     5     |5/D6(TX) |  D2   |     X      |
+ *     TX     |              RX                |     Serial1 TX1      |     4     |4/D7(RX) |  D3   |     X      |
+ * ---------------------------------------------------------------------------------------------------------------
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include "DFRobot_RTU.h"
+#include "DFRobot_RTU_Report.h"
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+#include <SoftwareSerial.h>
+#endif
+
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+  SoftwareSerial mySerial(/*rx =*/4, /*tx =*/5);
+  DFRobot_RTU modbus(/*s =*/&mySerial);
+#else
+  DFRobot_RTU modbus(/*s =*/&Serial1);
+#endif
+
+DFRobot_RTU_Report report(/*rtu =*/&modbus, /*id =*/0x01, /*cmd =*/DFRobot_RTU::eCMD_READ_HOLDING, /*reg =*/100, /*regNum =*/16);
+
+void onChange(uint8_t id, uint16_t reg, uint16_t oldVal, uint16_t newVal){
+  Serial.print(id);
+  Serial.print(" reg ");
+  Serial.print(reg);
+  Serial.print(": ");
+  Serial.print(oldVal);
+  Serial.print(" -> ");
+  Serial.println(newVal);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while(!Serial){                                                     //Waiting for USB Serial COM port to open.
+  }
+
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+    mySerial.begin(9600);
+#elif defined(ESP32)
+  Serial1.begin(9600, SERIAL_8N1, /*rx =*/D3, /*tx =*/D2);
+#else
+  Serial1.begin(9600);
+#endif
+  if(report.begin() != 0){
+    Serial.println("Memory error");
+    while(1);
+  }
+  report.setCallback(onChange);
+  report.setDeadband(/*reg =*/101, /*type =*/DFRobot_RTU_Report::eRTU_DEADBAND_ABSOLUTE, /*value =*/5);
+  report.setDeadband(/*reg =*/102, /*type =*/DFRobot_RTU_Report::eRTU_DEADBAND_PERCENT | DFRobot_RTU_Report::eRTU_DEADBAND_SIGNED, /*value =*/10);
+}
+
+void loop() {
+  report.poll();
+  delay(100);
+}
@@ -0,0 +1,64 @@
+/*!
+ * @file coilImage.ino
+ * @brief 在本地维护modbus从机64个线圈的映像，修改只作用于映像，flush()时只把变化的线圈以最少的总线字节
+ * @n 通过FC05或FC0F写入从机。
+ * @n connected table
+ * ---------------------------------------------------------------------------------------------------------------
+ * sensor pin |             MCU                | Leonardo/Mega2560/M0 |    UNO    | ESP8266 | ESP32 |  microbit  |
+ *     VCC    |            3.3V/5V             |        VCC           |    VCC    |   VCC   |  VCC  |     X      |
+ *     GND    |              GND               |        GND           |    GND    |   GND   |  GND  |     X      |
+ *     RX     |              TX                |     Serial1 RX1      |     5     |5/D6(TX) |  D2   |     X      |
+ *     TX     |              RX                |     Serial1 TX1      |     4     |4/D7(RX) |  D3   |     X      |
+ * ---------------------------------------------------------------------------------------------------------------
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include "DFRobot_RTU.h"
+#include "DFRobot_RTU_CoilImage.h"
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+#include <SoftwareSerial.h>
+#endif
+
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+  SoftwareSerial mySerial(/*rx =*/4, /*tx =*/5);
+  DFRobot_RTU modbus(/*s =*/&mySerial);
+#else
+  DFRobot_RTU modbus(/*s =*/&Serial1);
+#endif
+
+DFRobot_RTU_CoilImage relays(/*rtu =*/&modbus, /*id =*/0x01, /*reg =*/0x0000, /*coilNum =*/64);
+
+void setup() {
+  Serial.begin(115200);
+  while(!Serial){                                                     //Waiting for USB Serial COM port to open.
+  }
+
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+    mySerial.begin(9600);
+#elif defined(ESP32)
+  Serial1.begin(9600, SERIAL_8N1, /*rx =*/D3, /*tx =*/D2);
+#else
+  Serial1.begin(9600);
+#endif
+  if(relays.begin() != 0){
+    Serial.println("Memory error");
+    while(1);
+  }
+  Serial.print("read coils: ");
+  Serial.println(relays.read());
+}
+
+void loop() {
+  static uint8_t step = 0;
+  relays.toggle(/*coil =*/step % 64);                         //Only one coil changes, sent by FC05
+  relays.setBits(/*coil =*/16, /*num =*/8, /*value =*/step);   //Up to 8 adjacent coils change, sent by one FC0F
+  Serial.print("flush: ");
+  Serial.println(relays.flush());
+  step++;
+  delay(1000);
+}
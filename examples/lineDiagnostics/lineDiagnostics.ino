@@ -0,0 +1,95 @@
+/*!
+ * @file lineDiagnostics.ino
+ * @brief 调试时自动检测从机的波特率和数据格式，读取从机的FC08总线计数器，并做回环(echo)测试得出线路的吞吐量和误码，
+ * @n 最后推荐线路可靠的最高波特率(需要从机能跟随主机的波特率，或者使用回环插头)。
+ * @n connected table
+ * ---------------------------------------------------------------------------------------------------------------
+ * sensor pin |             MCU                | Leonardo/Mega2560/M0 |    UNO    | ESP8266 | ESP32 |  microbit  |
+ *     VCC    |            3.3V/5V             |        VCC           |    VCC    |   VCC   |  VCC  |     X      |
+ *     GND    |              GND               |        GND           |    GND    |   GND   |  GND  |     X      |
+ *     RX     |              TX                |     Serial1 RX1      |     5     |5/D6(TX) |  D2   |     X      |
+ *     TX     |              RX                |     Serial1 TX1      |     4     |4/D7(RX) |  D3   |     X      |
+ * ---------------------------------------------------------------------------------------------------------------
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include "DFRobot_RTU.h"
+#include "DFRobot_RTU_Diagnostics.h"
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+#include <SoftwareSerial.h>
+#endif
+
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+  SoftwareSerial mySerial(/*rx =*/4, /*tx =*/5);
+  DFRobot_RTU modbus(/*s =*/&mySerial);
+#else
+  DFRobot_RTU modbus(/*s =*/&Serial1);
+#endif
+
+//Restart the serial port with the setting to try
+void serialConfig(uint32_t baud, uint8_t format){
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+  (void)format;                                                       //SoftwareSerial only supports 8N1
+  mySerial.begin(baud);
+#else
+  static const uint32_t config[] = {SERIAL_8N1, SERIAL_8E1, SERIAL_8O1, SERIAL_8N2};
+  Serial1.end();
+#if defined(ESP32)
+  Serial1.begin(baud, config[format], /*rx =*/D3, /*tx =*/D2);
+#else
+  Serial1.begin(baud, config[format]);
+#endif
+#endif
+}
+
+DFRobot_RTU_Diagnostics diag(/*rtu =*/&modbus, /*cb =*/serialConfig);
+
+void setup() {
+  uint32_t baud = 0;
+  uint8_t format = 0;
+  DFRobot_RTU_Diagnostics::sRtuDiagCounters_t counters;
+  DFRobot_RTU_Diagnostics::sRtuLineTest_t test;
+  const char *formatName[] = {"8N1", "8E1", "8O1", "8N2"};
+
+  Serial.begin(115200);
+  while(!Serial){                                                     //Waiting for USB Serial COM port to open.
+  }
+
+  if(diag.detect(/*id =*/0x01, &baud, &format) != 0){
+    Serial.println("No answer at any setting");
+    while(1);
+  }
+  Serial.print("detected: ");
+  Serial.print(baud);
+  Serial.print(" ");
+  Serial.println(formatName[format]);
+
+  if(diag.readCounters(/*id =*/0x01, &counters) == 0){
+    Serial.print("bus messages: ");
+    Serial.print(counters.busMessage);
+    Serial.print(", CRC errors: ");
+    Serial.print(counters.busCrcError);
+    Serial.print(", overruns: ");
+    Serial.println(counters.busOverrun);
+  }
+
+  diag.lineTest(/*id =*/0x01, /*count =*/100, /*size =*/32, &test);
+  Serial.print("echo ok ");
+  Serial.print(test.ok);
+  Serial.print("/");
+  Serial.print(test.sent);
+  Serial.print(", ");
+  Serial.print(test.bytesPerSecond);
+  Serial.println(" bytes/s");
+
+  Serial.print("recommended baudrate: ");
+  Serial.println(diag.recommendBaud(/*id =*/0x01, format, /*count =*/50, /*maxErrors =*/0));
+}
+
+void loop() {
+}
@@ -0,0 +1,65 @@
+/*!
+ * @file registerImage.ino
+ * @brief 在本地维护modbus从机一段保持寄存器的影子映像，每个控制周期修改多个设定值后调用flush()，
+ * @n 变化的寄存器会合并成最少的FC06/FC10请求写入从机，并回读校验。
+ * @n connected table
+ * ---------------------------------------------------------------------------------------------------------------
+ * sensor pin |             MCU                | Leonardo/Mega2560/M0 |    UNO    | ESP8266 | ESP32 |  microbit  |
+ *     VCC    |            3.3V/5V             |        VCC           |    VCC    |   VCC   |  VCC  |     X      |
+ *     GND    |              GND               |        GND           |    GND    |   GND   |  GND  |     X      |
+ *     RX     |              TX                |     Serial1 RX1      |     5     |5/D6(TX) |  D2   |     X      |
+ *     TX     |              RX                |     Serial1 TX1      |     4     |4/D7(RX) |  D3   |     X      |
+ * ---------------------------------------------------------------------------------------------------------------
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include "DFRobot_RTU.h"
+#include "DFRobot_RTU_RegisterImage.h"
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+#include <SoftwareSerial.h>
+#endif
+
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+  SoftwareSerial mySerial(/*rx =*/4, /*tx =*/5);
+  DFRobot_RTU modbus(/*s =*/&mySerial);
+#else
+  DFRobot_RTU modbus(/*s =*/&Serial1);
+#endif
+
+DFRobot_RTU_RegisterImage setpoints(/*rtu =*/&modbus, /*id =*/0x01, /*reg =*/0x0100, /*regNum =*/32);
+
+void setup() {
+  Serial.begin(115200);
+  while(!Serial){                                                     //Waiting for USB Serial COM port to open.
+  }
+
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+    mySerial.begin(9600);
+#elif defined(ESP32)
+  Serial1.begin(9600, SERIAL_8N1, /*rx =*/D3, /*tx =*/D2);
+#else
+  Serial1.begin(9600);
+#endif
+  if(setpoints.begin() != 0){
+    Serial.println("Memory error");
+    while(1);
+  }
+  Serial.print("read registers: ");
+  Serial.println(setpoints.read());
+}
+
+void loop() {
+  static uint16_t cycle = 0;
+  setpoints.set(/*reg =*/0x0100, /*val =*/cycle);
+  setpoints.set(/*reg =*/0x0101, /*val =*/cycle * 2);
+  setpoints.set(/*reg =*/0x0104, /*val =*/1000 - cycle);       //The 2 unchanged registers between are cheaper than another request
+  Serial.print("flush: ");
+  Serial.println(setpoints.flush(/*verify =*/true));
+  cycle++;
+  delay(1000);
+}
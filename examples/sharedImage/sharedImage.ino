@@ -0,0 +1,100 @@
+/*!
+ * @file sharedImage.ino
+ * @brief Linux主机(如树莓派等Linux下的Arduino环境)上只有一个发布进程访问总线，轮询的寄存器块写入共享内存/dev/shm/dfrobot_rtu，
+ * @n 其它任意数量的本地进程(历史记录、HMI、报警)以读者身份映射共享内存，不加锁、不访问总线即可读到一致的最新数据。
+ * @n 把RTU_SHM_PUBLISHER改为0编译出读者程序。没有Linux下的Arduino环境时，可在extras/host中用make sharedImage编译出
+ * @n 发布程序sharedImage和读者程序sharedImageReader，Serial1为环境变量RTU_SERIAL1指定的串口(默认/dev/ttyUSB0)。
+ * @n 其它开发板没有POSIX共享内存，本示例在其上只打印一条提示。
+ * @n connected table
+ * ---------------------------------------------------------------------------------------------------------------
+ * sensor pin |             MCU                | Leonardo/Mega2560/M0 |    UNO    | ESP8266 | ESP32 |  microbit  |
+ *     VCC    |            3.3V/5V             |        VCC           |    VCC    |   VCC   |  VCC  |     X      |
+ *     GND    |              GND               |        GND           |    GND    |   GND   |  GND  |     X      |
+ *     RX     |              TX                |     Serial1 RX1      |     5     |5/D6(TX) |  D2   |     X      |
+ *     TX     |              RX                |     Serial1 TX1      |     4     |4/D7(RX) |  D3   |     X      |
+ * ---------------------------------------------------------------------------------------------------------------
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include "DFRobot_RTU.h"
+#include "DFRobot_RTU_SharedImage.h"
+//Other boards have no POSIX shared memory, they only build a sketch printing a note.
+#if defined(__linux__)
+#ifndef RTU_SHM_PUBLISHER
+#define RTU_SHM_PUBLISHER  1                                          //1: The process polling the bus, 0: a reader
+#endif
+
+#if RTU_SHM_PUBLISHER
+  DFRobot_RTU modbus(/*s =*/&Serial1);
+  DFRobot_RTU_SharedImage image(/*rtu =*/&modbus, /*name =*/"/dfrobot_rtu");
+#else
+  DFRobot_RTU_SharedImageReader image(/*name =*/"/dfrobot_rtu");
+#endif
+
+void setup() {
+  Serial.begin(115200);
+#if RTU_SHM_PUBLISHER
+  Serial1.begin(9600);
+  modbus.setTimeoutTimeMs(100);
+  image.addBlock(/*id =*/0x20, /*cmd =*/DFRobot_RTU::eCMD_READ_HOLDING, /*reg =*/0x0000, /*num =*/10);
+  image.addBlock(/*id =*/0x20, /*cmd =*/DFRobot_RTU::eCMD_READ_COILS, /*reg =*/0x0000, /*num =*/16);
+  image.addBlock(/*id =*/0x21, /*cmd =*/DFRobot_RTU::eCMD_READ_INPUT, /*reg =*/0x0000, /*num =*/4);
+  while(image.begin() != 0){                                          //Another publisher owns the segment
+    Serial.println("begin failed");
+    delay(1000);
+  }
+#else
+  while(!image.open()){                                               //Waiting for the publisher
+    delay(100);
+  }
+#endif
+}
+
+void loop() {
+#if RTU_SHM_PUBLISHER
+  uint8_t ret = image.poll();
+  if(ret != 0){
+    Serial.print("poll error ");
+    Serial.println(ret);
+  }
+  delay(100);
+#else
+  uint16_t data[10];
+  uint64_t timeUs = 0;
+  if(!image.valid() && !image.open()){                                //The publisher restarted or stopped
+    delay(100);
+    return;
+  }
+  uint8_t ret = image.read(/*index =*/0, data, sizeof(data), &timeUs);
+  Serial.print("status ");
+  Serial.print(ret);
+  Serial.print(", age ");
+  Serial.print((uint32_t)((DFRobot_RTU_SharedImage::nowUs() - timeUs) / 1000));
+  Serial.print("ms, reg0 ");
+  Serial.println(data[0], HEX);
+  //Copy free access to one register, retried only when the publisher wrote the block meanwhile.
+  uint32_t seq = 0;
+  uint16_t reg3 = 0;
+  do{
+    seq = image.readBegin(/*index =*/0);
+    reg3 = ((const uint16_t *)image.getData(/*index =*/0))[3];
+  }while(image.readRetry(/*index =*/0, seq) && image.valid());
+  Serial.print("reg3 ");
+  Serial.println(reg3, HEX);
+  delay(1000);
+#endif
+}
+#else
+void setup() {
+  Serial.begin(115200);
+  Serial.println("sharedImage needs a Linux host");
+}
+
+void loop() {
+}
+#endif
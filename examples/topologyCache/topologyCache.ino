@@ -0,0 +1,84 @@
+/*!
+ * @file topologyCache.ino
+ * @brief 上电时先加载保存的总线拓扑(从机地址、FC11/FC2B身份信息、学习到的应答时间)，只校验缓存中的从机，
+ * @n 与总线不一致时才重新扫描全部地址并保存。ESP32保存在NVS中，UNO/Mega2560/ESP8266保存在EEPROM中。
+ * @n connected table
+ * ---------------------------------------------------------------------------------------------------------------
+ * sensor pin |             MCU                | Leonardo/Mega2560/M0 |    UNO    | ESP8266 | ESP32 |  microbit  |
+ *     VCC    |            3.3V/5V             |        VCC           |    VCC    |   VCC   |  VCC  |     X      |
+ *     GND    |              GND               |        GND           |    GND    |   GND   |  GND  |     X      |
+ *     RX     |              TX                |     Serial1 RX1      |     5     |5/D6(TX) |  D2   |     X      |
+ *     TX     |              RX                |     Serial1 TX1      |     4     |4/D7(RX) |  D3   |     X      |
+ * ---------------------------------------------------------------------------------------------------------------
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include "DFRobot_RTU.h"
+#include "DFRobot_RTU_Topology.h"
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+#include <SoftwareSerial.h>
+#endif
+
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+  SoftwareSerial mySerial(/*rx =*/4, /*tx =*/5);
+  DFRobot_RTU modbus(/*s =*/&mySerial);
+#else
+  DFRobot_RTU modbus(/*s =*/&Serial1);
+#endif
+
+#if defined(ESP32)
+  DFRobot_RTU_NVSStorage storage(/*ns =*/"rtu", /*key =*/"topology");
+  DFRobot_RTU_Topology topology(/*rtu =*/&modbus, /*storage =*/&storage);
+#elif defined(__AVR__)||defined(ESP8266)
+  DFRobot_RTU_EEPROMStorage storage(/*address =*/0, /*size =*/256);
+  DFRobot_RTU_Topology topology(/*rtu =*/&modbus, /*storage =*/&storage);
+#else
+  DFRobot_RTU_Topology topology(/*rtu =*/&modbus, /*storage =*/NULL);    //No EEPROM, discover at every start
+#endif
+
+void setup() {
+  Serial.begin(115200);
+  while(!Serial){                                                     //Waiting for USB Serial COM port to open.
+  }
+
+#if defined(ARDUINO_AVR_UNO)||defined(ESP8266)
+    mySerial.begin(9600);
+#elif defined(ESP32)
+  Serial1.begin(9600, SERIAL_8N1, /*rx =*/D3, /*tx =*/D2);
+#else
+  Serial1.begin(9600);
+#endif
+  modbus.setTimeoutTimeMs(30);                                        //Absent addresses cost this timeout during discovery
+  uint32_t start = millis();
+  bool cached = topology.begin(/*first =*/0x01, /*last =*/0xF7);
+  Serial.print(cached ? "cache verified in " : "bus discovered in ");
+  Serial.print(millis() - start);
+  Serial.println("ms");
+
+  for(uint8_t i = 0; i < topology.getCount(); i++){
+    const DFRobot_RTU_Topology::sRtuTopologyEntry_t *slave = topology.getEntry(i);
+    Serial.print("id ");
+    Serial.print(slave->id);
+    Serial.print(", identity source ");
+    Serial.print(slave->source);
+    Serial.print(", timeout ");
+    Serial.print(topology.getTimeout(slave->id));
+    Serial.println("ms");
+  }
+}
+
+void loop() {
+  for(uint8_t i = 0; i < topology.getCount(); i++){
+    uint8_t id = topology.getEntry(i)->id;
+    modbus.setTimeoutTimeMs(topology.getTimeout(id));               //The learned timeout of every slave
+    Serial.print(id);
+    Serial.print(": ");
+    Serial.println(modbus.readHoldingRegister(id, /*reg =*/0x0000), HEX);
+  }
+  delay(1000);
+}
@@ -0,0 +1,115 @@
+/*!
+ * @file Arduino.cpp
+ * @brief Minimal Arduino core for host builds.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include <time.h>
+#include "Arduino.h"
+
+static uint64_t nowUs(){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+//Like on a board, the clocks start at 0 when the program starts.
+static uint64_t _startUs = nowUs();
+
+unsigned long millis(){
+  return (unsigned long)((nowUs() - _startUs) / 1000);
+}
+
+unsigned long micros(){
+  return (unsigned long)(nowUs() - _startUs);
+}
+
+void delay(unsigned long ms){
+  struct timespec ts = {(time_t)(ms / 1000), (long)(ms % 1000) * 1000000L};
+  nanosleep(&ts, NULL);
+}
+
+void delayMicroseconds(unsigned int us){
+  struct timespec ts = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000L};
+  nanosleep(&ts, NULL);
+}
+
+void pinMode(uint8_t pin, uint8_t mode){
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val){
+  (void)pin;
+  (void)val;
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size){
+  size_t n = 0;
+  while(size--){
+    if(write(*buffer++) == 0) break;
+    n++;
+  }
+  return n;
+}
+
+size_t Print::write(const char *str){
+  return (str == NULL) ? 0 : write((const uint8_t *)str, strlen(str));
+}
+
+size_t Print::print(const char *str){
+  return write(str);
+}
+
+size_t Print::print(char c){
+  return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char n, int base){
+  return print((unsigned long)n, base);
+}
+
+size_t Print::print(int n, int base){
+  return print((long)n, base);
+}
+
+size_t Print::print(unsigned int n, int base){
+  return print((unsigned long)n, base);
+}
+
+size_t Print::print(long n, int base){
+  if((base == DEC) && (n < 0)) return print('-') + printNumber(-(unsigned long)n, DEC);
+  return printNumber((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base){
+  return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits){
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
+
+size_t Print::println(){
+  return write("\r\n");
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base){
+  char buf[8 * sizeof(long) + 1];
+  char *str = &buf[sizeof(buf) - 1];
+  if(base < 2) base = DEC;
+  *str = '\0';
+  do{
+    char c = n % base;
+    n /= base;
+    *--str = (c < 10) ? (c + '0') : (c + 'A' - 10);
+  }while(n);
+  return write(str);
+}
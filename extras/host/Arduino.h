@@ -0,0 +1,35 @@
+/*!
+ * @file Arduino.h
+ * @brief Minimal Arduino core for building the library on a Linux or macOS host, used by the tests of this folder.
+ * @n     Time comes from CLOCK_MONOTONIC, the pin functions do nothing, Serial and Serial1 are in HardwareSerial.h.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#ifndef __ARDUINO_H
+#define __ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "Stream.h"
+#include "HardwareSerial.h"
+
+#define LOW    0
+#define HIGH   1
+#define INPUT  0
+#define OUTPUT 1
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+#endif
@@ -0,0 +1,146 @@
+/*!
+ * @file HardwareSerial.cpp
+ * @brief Serial ports of the host build.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include "HardwareSerial.h"
+
+HardwareSerial Serial(NULL, NULL);
+HardwareSerial Serial1("RTU_SERIAL1", "/dev/ttyUSB0");
+
+HardwareSerial::HardwareSerial(const char *env, const char *path)
+  :_env(env), _path(path), _rx(-1), _tx(-1), _head(0), _tail(0){
+  if(_env == NULL){
+    _rx = STDIN_FILENO;
+    _tx = STDOUT_FILENO;
+  }
+}
+
+HardwareSerial::~HardwareSerial(){
+  end();
+}
+
+static speed_t toSpeed(unsigned long baud){
+  switch(baud){
+    case 1200:   return B1200;
+    case 2400:   return B2400;
+    case 4800:   return B4800;
+    case 9600:   return B9600;
+    case 19200:  return B19200;
+    case 38400:  return B38400;
+    case 57600:  return B57600;
+    case 115200: return B115200;
+    default:     return B0;
+  }
+}
+
+bool HardwareSerial::begin(unsigned long baud){
+  struct termios tio;
+  const char *path = NULL;
+  int fd = -1;
+  //The console keeps the settings of the terminal, only its output is used.
+  if(_env == NULL) return true;
+  end();
+  path = getenv(_env);
+  if(path == NULL) path = _path;
+  if((toSpeed(baud) == B0) || ((fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK)) < 0)) return false;
+  if(tcgetattr(fd, &tio) != 0){
+    //Not a tty, such as a FIFO of a simulator, it is used as it is.
+    _rx = _tx = fd;
+    return true;
+  }
+  cfmakeraw(&tio);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 0;
+  cfsetispeed(&tio, toSpeed(baud));
+  cfsetospeed(&tio, toSpeed(baud));
+  if(tcsetattr(fd, TCSANOW, &tio) != 0){
+    close(fd);
+    return false;
+  }
+  tcflush(fd, TCIOFLUSH);
+  _rx = _tx = fd;
+  return true;
+}
+
+void HardwareSerial::end(){
+  if((_env != NULL) && (_rx >= 0)) close(_rx);
+  if(_env != NULL) _rx = _tx = -1;
+  _head = _tail = 0;
+}
+
+void HardwareSerial::fill(){
+  ssize_t len = 0;
+  if((_rx < 0) || (_tail != _head)) return;
+  //The console is read only when it has data, a sketch printing to it must not block.
+  if(_rx == STDIN_FILENO){
+    fd_set fds;
+    struct timeval tv = {0, 0};
+    FD_ZERO(&fds);
+    FD_SET(_rx, &fds);
+    if(select(_rx + 1, &fds, NULL, NULL, &tv) <= 0) return;
+  }
+  _head = _tail = 0;
+  if((len = ::read(_rx, _buf, sizeof(_buf))) > 0) _tail = len;
+}
+
+int HardwareSerial::available(){
+  fill();
+  return _tail - _head;
+}
+
+int HardwareSerial::read(){
+  fill();
+  return (_head < _tail) ? _buf[_head++] : -1;
+}
+
+int HardwareSerial::peek(){
+  fill();
+  return (_head < _tail) ? _buf[_head] : -1;
+}
+
+size_t HardwareSerial::write(uint8_t c){
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size){
+  size_t n = 0;
+  ssize_t len = 0;
+  if(_tx < 0) return 0;
+  while(n < size){
+    if((len = ::write(_tx, buffer + n, size - n)) > 0){
+      n += len;
+    }else if((len < 0) && (errno != EAGAIN) && (errno != EINTR)){
+      break;
+    }
+  }
+  return n;
+}
+
+void HardwareSerial::flush(){
+  if(_tx < 0) return;
+  if(_tx == STDOUT_FILENO){
+    fflush(stdout);
+  }else{
+    tcdrain(_tx);
+  }
+}
+
+HardwareSerial::operator bool(){
+  return _tx >= 0;
+}
@@ -0,0 +1,62 @@
+/*!
+ * @file HardwareSerial.h
+ * @brief Serial and Serial1 of the host build. Serial is the console(stdin and stdout), Serial1 is a serial port of
+ * @n     the host opened with termios, the device is $RTU_SERIAL1 or /dev/ttyUSB0.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#ifndef __HARDWARE_SERIAL_H
+#define __HARDWARE_SERIAL_H
+
+#include "Stream.h"
+
+#define SERIAL_RX_BUFFER_SIZE 256
+
+class HardwareSerial: public Stream{
+public:
+/**
+ * @brief HardwareSerial constructor.
+ * @param env: Environment variable holding the device, NULL: the console.
+ * @param path: Device used when the variable is not set.
+ */
+  HardwareSerial(const char *env, const char *path);
+  ~HardwareSerial();
+
+/**
+ * @brief Open the device in raw mode, 8 data bits, no parity, 1 stop bit. The console is not changed.
+ * @param baud: Baudrate, one of the standard rates from 1200 to 115200.
+ * @return true: sucess, false: the device could not be opened or configured.
+ */
+  bool begin(unsigned long baud);
+  void end();
+  int available();
+  int read();
+  int peek();
+  size_t write(uint8_t c);
+  size_t write(const uint8_t *buffer, size_t size);
+  using Print::write;
+/**
+ * @brief Wait until every written byte has left the port, like flush() of the Arduino core.
+ */
+  void flush();
+  operator bool();
+
+private:
+  void fill();
+  const char *_env;
+  const char *_path;
+  int _rx;
+  int _tx;
+  uint8_t _buf[SERIAL_RX_BUFFER_SIZE];
+  uint16_t _head;
+  uint16_t _tail;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+#endif
@@ -0,0 +1,24 @@
+/*!
+ * @file Stream.h
+ * @brief The Arduino Stream interface, for host builds.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#ifndef __STREAM_H
+#define __STREAM_H
+
+#include "Print.h"
+
+class Stream: public Print{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual void flush(){}
+};
+#endif
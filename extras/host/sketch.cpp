@@ -0,0 +1,23 @@
+/*!
+ * @file sketch.cpp
+ * @brief main() of an example built on the host, it calls setup() once and loop() forever like the Arduino core.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include "Arduino.h"
+
+void setup();
+void loop();
+
+int main(){
+  setup();
+  while(1){
+    loop();
+  }
+  return 0;
+}
@@ -0,0 +1,286 @@
+/*!
+ * @file test_parser.cpp
+ * @brief Property test of the answer parser(recvFrame/checkFrame). Random answers of every function code are received
+ * @n     back to back, and behind any mix of random bytes, request echoes, truncated and corrupted copies of the
+ * @n     answer. Every answer must be received byte for byte, and a stream without a complete answer must time out.
+ * @n     make test
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include <Arduino.h>
+#include "DFRobot_RTU.h"
+
+#define TEST_STREAMS                               20000
+#define TEST_MAX_ANSWERS                           3
+#define TEST_MAX_NOISE                             3
+#define TEST_STREAM_SIZE                           4096
+
+//A receive buffer filled by the test, nothing written to it is sent anywhere.
+class MockStream: public Stream{
+public:
+  MockStream():_head(0), _tail(0){}
+  void clear(){ _head = _tail = 0; }
+  void push(const uint8_t *data, uint16_t len){
+    while(len-- && (_tail < TEST_STREAM_SIZE)) _buf[_tail++] = *data++;
+  }
+  int available(){ return _tail - _head; }
+  int read(){ return (_head < _tail) ? _buf[_head++] : -1; }
+  int peek(){ return (_head < _tail) ? _buf[_head] : -1; }
+  size_t write(uint8_t){ return 1; }
+private:
+  uint8_t _buf[TEST_STREAM_SIZE];
+  uint16_t _head;
+  uint16_t _tail;
+};
+
+//Exposes the parser of the master.
+class ParserTest: public DFRobot_RTU{
+public:
+  ParserTest(Stream *s):DFRobot_RTU(s){}
+  using DFRobot_RTU::recvFrame;
+  using DFRobot_RTU::checkFrame;
+  using DFRobot_RTU::calculateCRC;
+};
+
+typedef struct{
+  uint8_t id;
+  uint8_t cmd;
+  uint16_t data;         /**<The data argument of recvFrame for this answer*/
+  uint16_t len;
+  uint8_t frame[RTU_MAX_FRAME_SIZE];
+}sAnswer_t;
+
+static const uint8_t _cmds[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x08, 0x0F, 0x10, 0x11, 0x2B};
+static MockStream _stream;
+static ParserTest _parser(&_stream);
+static uint32_t _seed = 1;
+static uint32_t _failed = 0;
+static uint32_t _answers = 0;
+static uint32_t _ambiguous = 0;
+
+static uint32_t random32(){
+  //xorshift32, the same sequence on every host.
+  _seed ^= _seed << 13;
+  _seed ^= _seed >> 17;
+  _seed ^= _seed << 5;
+  return _seed;
+}
+
+static uint16_t random16(uint16_t max){
+  return (uint16_t)(random32() % max);
+}
+
+static void appendCRC(uint8_t *frame, uint16_t len){
+  uint16_t crc = _parser.calculateCRC(frame, len);
+  frame[len] = crc >> 8;
+  frame[len + 1] = crc & 0xFF;
+}
+
+static void randomAnswer(sAnswer_t *a){
+  uint16_t len = 2, n = 0, objects = 0;
+  a->id = 1 + random16(0xF7);
+  a->cmd = _cmds[random16(sizeof(_cmds))];
+  a->frame[0] = a->id;
+  a->frame[1] = a->cmd;
+  if(random16(8) == 0){
+    a->frame[1] |= 0x80;
+    a->frame[len++] = 1 + random16(4);
+    //An exception answer matches any request of its function code.
+    a->data = random16(0x100);
+  }else{
+    switch(a->cmd){
+      case 0x01:
+      case 0x02:
+      case 0x03:
+      case 0x04:
+        n = 1 + random16(RTU_MAX_FRAME_SIZE - 5);
+        if(a->cmd >= 0x03) n = (n + 1) & ~1;
+        if(n > (RTU_MAX_FRAME_SIZE - 5)) n -= 2;
+        a->data = n;
+        a->frame[len++] = n;
+        while(n--) a->frame[len++] = random16(0x100);
+        break;
+      case 0x05:
+      case 0x06:
+      case 0x0F:
+      case 0x10:
+        a->data = random16(0xFFFF);
+        a->frame[len++] = a->data >> 8;
+        a->frame[len++] = a->data & 0xFF;
+        a->frame[len++] = random16(0x100);
+        a->frame[len++] = random16(0x100);
+        break;
+      case 0x08:
+        n = 2 + random16(32);
+        a->data = n;
+        while(n--) a->frame[len++] = random16(0x100);
+        break;
+      case 0x11:
+        n = random16(64);
+        a->data = 0;
+        a->frame[len++] = n;
+        while(n--) a->frame[len++] = random16(0x100);
+        break;
+      case 0x2B:
+        a->data = 0;
+        a->frame[len++] = 0x0E;
+        a->frame[len++] = 0x01;
+        a->frame[len++] = 0x01;
+        a->frame[len++] = 0x00;
+        a->frame[len++] = 0x00;
+        objects = random16(4);
+        a->frame[len++] = objects;
+        while(objects--){
+          n = random16(24);
+          a->frame[len++] = random16(0x100);
+          a->frame[len++] = n;
+          while(n--) a->frame[len++] = random16(0x100);
+        }
+        break;
+    }
+  }
+  appendCRC(a->frame, len);
+  a->len = len + 2;
+}
+
+//Bytes before an answer: random bytes, the echo of the request, a truncated or a corrupted copy of the answer.
+static void pushNoise(const sAnswer_t *a){
+  uint8_t noise[RTU_MAX_FRAME_SIZE + 8];
+  uint16_t len = 0, n = 0;
+  switch(random16(5)){
+    case 0:
+      break;
+    case 1:
+      len = random16(16);
+      for(uint16_t i = 0; i < len; i++) noise[i] = random16(0x100);
+      break;
+    case 2:
+      //A request is its own valid answer for FC05, FC06 and FC08, those echoes can not be told apart.
+      if((a->cmd == 0x05) || (a->cmd == 0x06) || (a->cmd == 0x08)) break;
+      noise[len++] = a->id;
+      noise[len++] = a->cmd;
+      if(a->cmd == 0x2B){
+        noise[len++] = 0x0E;
+        noise[len++] = 0x01;
+        noise[len++] = 0x00;
+      }else if(a->cmd != 0x11){
+        noise[len++] = random16(0x100);
+        noise[len++] = random16(0x100);
+        noise[len++] = 0x00;
+        noise[len++] = random16(0x80);
+      }
+      if((a->cmd == 0x0F) || (a->cmd == 0x10)){
+        n = 1 + random16(16);
+        noise[len++] = n;
+        while(n--) noise[len++] = random16(0x100);
+      }
+      appendCRC(noise, len);
+      len += 2;
+      break;
+    case 3:
+      len = 1 + random16(a->len - 1);
+      memcpy(noise, a->frame, len);
+      break;
+    case 4:
+      len = a->len;
+      memcpy(noise, a->frame, len);
+      noise[random16(len)] ^= 1 << random16(8);
+      break;
+  }
+  _stream.push(noise, len);
+}
+
+static void fail(const char *what, uint32_t stream, const sAnswer_t *a){
+  _failed++;
+  if(_failed > 10) return;
+  printf("FAIL %s: stream %u, id %02X cmd %02X data %u len %u\n", what, stream, a->id, a->cmd, a->data, a->len);
+}
+
+//Every prefix of an answer is accepted as the beginning of it, and the whole answer has its exact length.
+static void testPrefix(uint32_t stream, const sAnswer_t *a){
+  uint16_t length = 0;
+  for(uint16_t i = 1; i <= a->len; i++){
+    length = _parser.checkFrame((uint8_t *)a->frame, i, a->id, a->cmd, a->data);
+    if((length < i) || ((i == a->len) && (length != a->len))){
+      fail("checkFrame", stream, a);
+      return;
+    }
+  }
+}
+
+//Whether the received bytes are a valid answer on their own, noise matches a CRC by chance once in 65536 windows.
+static bool isAnswer(uint8_t *frame, uint16_t length, const sAnswer_t *a){
+  uint16_t crc = 0;
+  if((length < 4) || (_parser.checkFrame(frame, length, a->id, a->cmd, a->data) != length)) return false;
+  crc = (frame[length - 2] << 8) | frame[length - 1];
+  return crc == _parser.calculateCRC(frame, length - 2);
+}
+
+//Receive the answers of the stream in order, each of them byte for byte with its exception code.
+static void receive(uint32_t stream, const sAnswer_t *answers, uint16_t num){
+  uint8_t frame[RTU_MAX_FRAME_SIZE];
+  uint16_t length = 0;
+  uint8_t error = 0;
+  for(uint16_t i = 0; i < num; i++){
+    length = _parser.recvFrame(frame, answers[i].id, answers[i].cmd, answers[i].data, &error);
+    if((length != answers[i].len) || (memcmp(frame, answers[i].frame, length) != 0)){
+      //Noise that forms a valid answer with the bytes after it can not be told apart from the answer.
+      if((num == 1) && isAnswer(frame, length, &answers[i])){
+        _ambiguous++;
+        return;
+      }
+      fail("lost answer", stream, &answers[i]);
+      return;
+    }
+    if(error != ((answers[i].frame[1] & 0x80) ? answers[i].frame[2] : 0)){
+      fail("wrong error", stream, &answers[i]);
+      return;
+    }
+    _answers++;
+  }
+}
+
+int main(){
+  static sAnswer_t answers[TEST_MAX_ANSWERS];
+  uint8_t frame[RTU_MAX_FRAME_SIZE];
+  uint8_t trailer[16];
+  uint16_t num = 0, len = 0;
+  uint8_t error = 0;
+  //Timeouts only happen once the stream is empty, 1 ms is enough.
+  _parser.setTimeoutTimeMs(0);
+  for(uint32_t s = 0; s < TEST_STREAMS; s++){
+    //Back to back answers, the parser must not read past the end of an answer.
+    _stream.clear();
+    num = 1 + random16(TEST_MAX_ANSWERS);
+    for(uint16_t i = 0; i < num; i++){
+      randomAnswer(&answers[i]);
+      testPrefix(s, &answers[i]);
+      _stream.push(answers[i].frame, answers[i].len);
+    }
+    receive(s, answers, num);
+    //One answer behind any mix of noise, followed by garbage.
+    _stream.clear();
+    randomAnswer(&answers[0]);
+    num = random16(TEST_MAX_NOISE + 1);
+    for(uint16_t i = 0; i < num; i++) pushNoise(&answers[0]);
+    _stream.push(answers[0].frame, answers[0].len);
+    len = random16(sizeof(trailer));
+    for(uint16_t i = 0; i < len; i++) trailer[i] = random16(0x100);
+    _stream.push(trailer, len);
+    receive(s, answers, 1);
+    //A truncated answer alone times out, every timeout costs 1 ms, so only some streams check it.
+    if((s % 100) != 0) continue;
+    _stream.clear();
+    _stream.push(answers[0].frame, answers[0].len - 1);
+    if((_parser.recvFrame(frame, answers[0].id, answers[0].cmd, answers[0].data, &error) != 0) || (error != DFRobot_RTU::eRTU_RECV_ERROR)){
+      fail("truncated answer accepted", s, &answers[0]);
+    }
+  }
+  printf("%s: %u streams, %u answers, %u noise answers, %u failures\n", _failed ? "FAIL" : "PASS", (unsigned)TEST_STREAMS, _answers, _ambiguous, _failed);
+  return _failed ? 1 : 0;
+}
@@ -38,6 +38,8 @@ class DFRobot_RTU(object):
   eCMD_WRITE_MULTI_COILS    = 0x0F
   eCMD_WRITE_MULTI_HOLDING  = 0x10
 
+  RTU_RESYNC_TIMEOUT        = 0.005 #s to wait for more bytes after a CRC error
+
   def __init__(self, baud, bits, parity, stopbit):
     '''
       @brief Serial initialization.
@@ -462,80 +464,79 @@ class DFRobot_RTU(object):
       self._ser.write(l)
       time.sleep(self._timeout)
 
+  def _check_frame(self, frame, id, cmd, val):
+    '''
+      @brief Check whether the received bytes can be the beginning of the answer of a request.
+      @return 0: Not the answer, others: The length of the whole answer, including the CRC.
+    '''
+    if cmd < 5:
+      size = 5 + (val & 0xFF)
+    elif cmd in (self.eCMD_WRITE_COILS, self.eCMD_WRITE_HOLDING, self.eCMD_WRITE_MULTI_COILS, self.eCMD_WRITE_MULTI_HOLDING):
+      size = 8
+    else:
+      size = 5
+    if len(frame) >= 1 and frame[0] != id:
+      return 0
+    if len(frame) >= 2 and (frame[1] & 0x7F) != cmd:
+      return 0
+    if len(frame) < 2 or (frame[1] & 0x80):
+      return 5
+    if cmd < 5:
+      if len(frame) >= 3 and frame[2] != (val & 0xFF):
+        return 0
+    elif size == 8:
+      if len(frame) >= 4 and (((frame[2] << 8) | frame[3]) & 0xFFFF) != val:
+        return 0
+    return size
+
   def recv_and_parse_package(self, id, cmd, val):
     package = [self.eRTU_ID_ERROR]
     if id == 0:
       return [0]
     if (id < 1) or (id > 0xF7):
       return package
-    head = [0]*4
-    index = 0
+    window = []
+    crc_error = False
     t = time.time()
-    remain = 0
-    while remain < 4:
+    while True:
       if self._ser.inWaiting():
         data = self._ser.read(1)
         try: 
-          head[index] = ord(data)
+          window.append(ord(data))
         except:
-          head[index] = data
-        #print("%d = %02X"%(index, head[index]))
-        index += 1
-        if (index == 1) and (head[0] != id):
-          index = 0
-        elif (index == 2) and ((head[1] & 0x7F) != cmd):
-          index = 0
-        remain = index
+          window.append(data)
         t = time.time()
-      if time.time() - t > self._timeout:
-        #print("time out.")
-        return [self.eRTU_RECV_ERROR]
-      if(index == 4):
-        if head[1] & 0x80:
-          index = 5
-        else:
-          if head[1] < 5:
-            if head[2] != (val & 0xFF):
-              index = 0
-              remain = 0
-            else:
-              index = 5 + head[2]
-          else:
-            if (((head[2] << 8) | head[3]) & 0xFFFF) != val:
-              index = 0
-              remain = 0
-            else:
-              index = 8
-        if index > 0:
-          package = [0]*(index + 1)
-          package[1:5] = head
-          remain = index - 4
-          index = 5
-          t = time.time()
-          while remain > 0:
-            if self._ser.inWaiting():
-              data = self._ser.read(1)
-              try: 
-                package[index] = ord(data)
-              except:
-                package[index] = data
-              index += 1
-              remain -= 1
-              t = time.time()
-            if(time.time() - t >self._timeout):
-              print("time out1.")
-              return [self.eRTU_RECV_ERROR]
-          crc = ((package[len(package) - 2] << 8) | package[len(package) - 1]) & 0xFFFF
-          if crc != self._calculate_crc(package[1:len(package) - 2]):
-            print("CRC ERROR")
-            return [self.eRTU_RECV_ERROR]
-          if package[2] & 0x80:
-            package[0] = package[3]
-          else:
-            package[0] = 0
-          #lin = ['%02X' % i for i in package]
-          #print(" ".join(lin))
-          return package
-
-
-
+        crc_error = False
+      else:
+        timeout = self._timeout
+        if crc_error and len(window) == 0:
+          timeout = min(self._timeout, self.RTU_RESYNC_TIMEOUT)
+        if time.time() - t <= timeout:
+          continue
+        if len(window) == 0:
+          #print("time out.")
+          return [self.eRTU_RECV_ERROR]
+        #The candidate never completed(a stale byte count or echo), a whole answer may follow its first byte.
+        window.pop(0)
+      length = 0
+      #Not the answer, slide the window by one byte and check again, a glitch byte costs no timeout.
+      while len(window):
+        length = self._check_frame(window, id, cmd, val)
+        if length and len(window) < length:
+          break
+        #More bytes than the answer only remain after a timeout slide, the rest of the window is dropped.
+        if length:
+          crc = ((window[length - 2] << 8) | window[length - 1]) & 0xFFFF
+          if crc == self._calculate_crc(window[:length - 2]):
+            break
+          crc_error = True
+        window.pop(0)
+      if len(window) and len(window) >= length:
+        window = window[:length]
+        break
+    package = [0] + window
+    if package[2] & 0x80:
+      package[0] = package[3]
+    #lin = ['%02X' % i for i in package]
+    #print(" ".join(lin))
+    return package
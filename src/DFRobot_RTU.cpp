@@ -12,31 +12,117 @@
 #include <Arduino.h>
 #include "DFRobot_RTU.h"
 
+#if RTU_ENABLE_STATISTICS
+#define RTU_STAT(x) (_stat.x++)
+#else
+#define RTU_STAT(x)
+#endif
+
+#if RTU_CRC_TABLE
+#if defined(__AVR__)
+static const uint16_t _crcTable[256] PROGMEM = {
+#else
+static const uint16_t _crcTable[256] = {
+#endif
+  0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+  0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+  0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+  0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+  0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+  0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+  0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+  0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+  0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+  0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+  0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+  0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+  0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+  0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+  0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+  0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+  0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+  0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+  0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+  0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+  0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+  0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+  0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+  0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+  0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+  0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+  0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+  0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+  0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+  0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+  0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+  0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040,
+};
+#if defined(__AVR__)
+#define RTU_CRC_TABLE_READ(i) pgm_read_word(&_crcTable[i])
+#else
+#define RTU_CRC_TABLE_READ(i) _crcTable[i]
+#endif
+#endif
+
 DFRobot_RTU::DFRobot_RTU(Stream *s,int dePin)
-  :_timeout(100), _s(s),_dePin(dePin){
+  :_timeout(100), _s(s),_dePin(dePin), _lastUs(0){
   if(_dePin>0){
     pinMode(_dePin,OUTPUT);
   }
+  setBaudrate();
+#if RTU_ENABLE_STATISTICS
+  clearStatistics();
+#endif
 }
 
 DFRobot_RTU::DFRobot_RTU(Stream *s)
-  :_timeout(100), _s(s),_dePin(-1){
+  :_timeout(100), _s(s),_dePin(-1), _lastUs(0){
   if(_dePin>0){
     pinMode(_dePin,OUTPUT);
   }
+  setBaudrate();
+#if RTU_ENABLE_STATISTICS
+  clearStatistics();
+#endif
 }
 
 DFRobot_RTU::DFRobot_RTU()
-  : _timeout(100), _s(NULL),_dePin(-1){
+  : _timeout(100), _s(NULL),_dePin(-1), _lastUs(0){
   if(_dePin>0){
     pinMode(_dePin,OUTPUT);
   }
+  setBaudrate();
+#if RTU_ENABLE_STATISTICS
+  clearStatistics();
+#endif
 }
 
 void DFRobot_RTU::setTimeoutTimeMs(uint32_t timeout){
   _timeout = timeout;
 }
 
+uint32_t DFRobot_RTU::getTimeoutTimeMs(){
+  return _timeout;
+}
+
+void DFRobot_RTU::setBaudrate(uint32_t baud){
+  if(baud == 0) return;
+  _baud = baud;
+  //A character is 11 bits(start, 8 data, parity or second stop, stop), t3.5 is fixed to 1750us above 19200.
+  _t35Us = (baud > 19200) ? 1750 : (38500000UL / baud);
+}
+
+#if RTU_ENABLE_STATISTICS
+void DFRobot_RTU::getStatistics(sRtuStatistics_t *stat){
+  if(stat != NULL) memcpy(stat, &_stat, sizeof(_stat));
+}
+
+void DFRobot_RTU::clearStatistics(){
+  memset(&_stat, 0, sizeof(_stat));
+}
+#endif
+
+#if RTU_ENABLE_FC01
 bool DFRobot_RTU::readCoilsRegister(uint8_t id, uint16_t reg){
   uint8_t temp[] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), 0x00, 0x01};
   bool val = false;
@@ -56,7 +142,9 @@ bool DFRobot_RTU::readCoilsRegister(uint8_t id, uint16_t reg){
   RTU_DBG(val, HEX);
   return val;
 }
+#endif
 
+#if RTU_ENABLE_FC02
 bool DFRobot_RTU::readDiscreteInputsRegister(uint8_t id, uint16_t reg){
   uint8_t temp[] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), 0x00, 0x01};
   uint8_t *pData = NULL;
@@ -77,7 +165,9 @@ bool DFRobot_RTU::readDiscreteInputsRegister(uint8_t id, uint16_t reg){
   RTU_DBG(val, HEX);
   return val;
 }
+#endif
 
+#if RTU_ENABLE_FC03
 uint16_t DFRobot_RTU::readHoldingRegister(uint8_t id, uint16_t reg){
   uint8_t temp[] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), 0x00, 0x01};
   uint16_t val = 0;
@@ -98,7 +188,9 @@ uint16_t DFRobot_RTU::readHoldingRegister(uint8_t id, uint16_t reg){
   //RTU_DBG(val, HEX);
   return val;
 }
+#endif
 
+#if RTU_ENABLE_FC04
 uint16_t DFRobot_RTU::readInputRegister(uint8_t id, uint16_t reg){
   uint8_t temp[] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), 0x00, 0x01};
   uint16_t val = 0;
@@ -124,7 +216,9 @@ uint16_t DFRobot_RTU::readInputRegister(uint8_t id, uint16_t reg){
   RTU_DBG(val, HEX);
   return val;
 }
+#endif
 
+#if RTU_ENABLE_FC05
 uint8_t DFRobot_RTU::writeCoilsRegister(uint8_t id, uint16_t reg, bool flag){
   uint16_t val = flag ? 0xFF00 : 0x0000;
   uint8_t temp[] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), (uint8_t)((val >> 8) & 0xFF), (uint8_t)(val & 0xFF)};
@@ -141,6 +235,8 @@ uint8_t DFRobot_RTU::writeCoilsRegister(uint8_t id, uint16_t reg, bool flag){
   }
   return ret;
 }
+#endif
+#if RTU_ENABLE_FC06
 uint8_t DFRobot_RTU::writeHoldingRegister(uint8_t id, uint16_t reg, uint16_t val){
   uint8_t temp[] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), (uint8_t)((val >> 8) & 0xFF), (uint8_t)(val & 0xFF)};
   uint8_t ret = 0;
@@ -165,11 +261,15 @@ uint8_t DFRobot_RTU::writeHoldingRegister(uint8_t id, uint16_t reg, uint16_t val
   //RTU_DBG(val, HEX);
   return ret;
 }
+#endif
 
+#if RTU_ENABLE_FC01
 uint8_t DFRobot_RTU::readCoilsRegister(uint8_t id, uint16_t reg, uint16_t regNum, uint8_t *data, uint16_t size){
   uint8_t length = regNum/8 + ((regNum%8) ? 1 : 0);
   uint8_t temp[] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), (uint8_t)((regNum >> 8) & 0xFF), (uint8_t)(regNum & 0xFF)};
   uint8_t ret = 0;
+  //Refused before it is sent, the slave must not execute a request whose answer does not fit a frame.
+  if((regNum == 0) || (regNum > RTU_MAX_READ_COILS)) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
   if((id == 0) && (id > 0xF7)){
     RTU_DBG("Device id error");
     return eRTU_ID_ERROR;
@@ -186,10 +286,14 @@ uint8_t DFRobot_RTU::readCoilsRegister(uint8_t id, uint16_t reg, uint16_t regNum
   }
   return ret;
 }
+#endif
+#if RTU_ENABLE_FC02
 uint8_t DFRobot_RTU::readDiscreteInputsRegister(uint8_t id, uint16_t reg, uint16_t regNum, uint8_t *data, uint16_t size){
   uint8_t length = regNum/8 + ((regNum%8) ? 1 : 0);
   uint8_t temp[] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), (uint8_t)((regNum >> 8) & 0xFF), (uint8_t)(regNum & 0xFF)};
   uint8_t ret = 0;
+  //Refused before it is sent, the slave must not execute a request whose answer does not fit a frame.
+  if((regNum == 0) || (regNum > RTU_MAX_READ_COILS)) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
   if((id == 0) && (id > 0xF7)){
     RTU_DBG("Device id error");
     return eRTU_ID_ERROR;
@@ -206,10 +310,13 @@ uint8_t DFRobot_RTU::readDiscreteInputsRegister(uint8_t id, uint16_t reg, uint16
   }
   return ret;
 }
+#endif
+#if RTU_ENABLE_FC03
 uint8_t DFRobot_RTU::readHoldingRegister(uint8_t id, uint16_t reg, void *data, uint16_t size){
-  uint8_t length = size/2 + ((size%2) ? 1 : 0);
+  uint16_t length = size/2 + ((size%2) ? 1 : 0);
   uint8_t temp[] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), (uint8_t)((length >> 8) & 0xFF), (uint8_t)(length & 0xFF)};
   uint8_t ret = 0;
+  if((length == 0) || (length > RTU_MAX_READ_REGISTERS)) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
   if((id == 0) && (id > 0xF7)){
     RTU_DBG("Device id error");
     return eRTU_ID_ERROR;
@@ -223,11 +330,14 @@ uint8_t DFRobot_RTU::readHoldingRegister(uint8_t id, uint16_t reg, void *data, u
   }
   return ret;
 }
+#endif
 
+#if RTU_ENABLE_FC04
 uint8_t DFRobot_RTU::readInputRegister(uint8_t id, uint16_t reg, void *data, uint16_t size){
-  uint8_t length = size/2 + ((size%2) ? 1 : 0);
+  uint16_t length = size/2 + ((size%2) ? 1 : 0);
   uint8_t temp[] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), (uint8_t)((length >> 8) & 0xFF), (uint8_t)(length & 0xFF)};
   uint8_t ret = 0;
+  if((length == 0) || (length > RTU_MAX_READ_REGISTERS)) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
   if((id == 0) && (id > 0xF7)){
     RTU_DBG("Device id error");
     return eRTU_ID_ERROR;
@@ -242,10 +352,14 @@ uint8_t DFRobot_RTU::readInputRegister(uint8_t id, uint16_t reg, void *data, uin
   RTU_DBG(val, HEX);
   return ret;
 }
+#endif
 
+#if RTU_ENABLE_FC03
 uint8_t DFRobot_RTU::readHoldingRegister(uint8_t id, uint16_t reg, uint16_t *data, uint16_t regNum){
   uint8_t temp[] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), (uint8_t)((regNum >> 8) & 0xFF), (uint8_t)(regNum & 0xFF)};
   uint8_t ret = 0;
+  //Refused before it is sent, the slave must not execute a request whose answer does not fit a frame.
+  if((regNum == 0) || (regNum > RTU_MAX_READ_REGISTERS)) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
   if((id == 0) && (id > 0xF7)){
     RTU_DBG("Device id error");
     return eRTU_ID_ERROR;
@@ -263,10 +377,14 @@ uint8_t DFRobot_RTU::readHoldingRegister(uint8_t id, uint16_t reg, uint16_t *dat
   }
   return ret;
 }
+#endif
 
+#if RTU_ENABLE_FC04
 uint8_t DFRobot_RTU::readInputRegister(uint8_t id, uint16_t reg, uint16_t *data, uint16_t regNum){
   uint8_t temp[] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), (uint8_t)((regNum >> 8) & 0xFF), (uint8_t)(regNum & 0xFF)};
   uint8_t ret = 0;
+  //Refused before it is sent, the slave must not execute a request whose answer does not fit a frame.
+  if((regNum == 0) || (regNum > RTU_MAX_READ_REGISTERS)) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
   if((id == 0) && (id > 0xF7)){
     RTU_DBG("Device id error");
     return eRTU_ID_ERROR;
@@ -284,98 +402,341 @@ uint8_t DFRobot_RTU::readInputRegister(uint8_t id, uint16_t reg, uint16_t *data,
   }
   return ret;
 }
+#endif
 
+#if RTU_ENABLE_FC0F
 uint8_t DFRobot_RTU::writeCoilsRegister(uint8_t id, uint16_t reg, uint16_t regNum, uint8_t *data, uint16_t size){
   uint16_t length = regNum/8 + ((regNum%8) ? 1 : 0);
-  if(size < length) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
-  //#if defined(ESP8266)
-  uint8_t temp[size + 5];
-  temp[0] = (uint8_t)((reg >> 8) & 0xFF);
-  temp[1] = (uint8_t)(reg & 0xFF);
-  temp[2] = (uint8_t)((regNum >> 8) & 0xFF);
-  temp[3] = (uint8_t)(regNum & 0xFF);
-  temp[4] = (uint8_t)length;
-  //#else
-  //uint8_t temp[size + 5] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF),(uint8_t)((regNum >> 8) & 0xFF), (uint8_t)(regNum & 0xFF),(uint8_t)length};
-  //#endif
+  pRtuPacketHeader_t header = NULL;
+  uint8_t *pdu = NULL;
   uint8_t ret = 0;
+  if((data == NULL) || (size < length) || ((length + 5) > (RTU_MAX_FRAME_SIZE - 4))) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
   if(id > 0xF7){
     RTU_DBG("Device id error");
     return (uint8_t)eRTU_ID_ERROR;
   }
-  memcpy(temp+5, data, size);
-  pRtuPacketHeader_t header = packed(id, eCMD_WRITE_MULTI_COILS, temp, sizeof(temp));
+  //The request is built in place, no copy of the data on the stack.
+  if((header = packedAlloc(id, eCMD_WRITE_MULTI_COILS, length + 5)) == NULL) return (uint8_t)eRTU_MEMORY_ERROR;
+  pdu = (uint8_t *)&(header->id);
+  pdu[2] = (uint8_t)((reg >> 8) & 0xFF);
+  pdu[3] = (uint8_t)(reg & 0xFF);
+  pdu[4] = (uint8_t)((regNum >> 8) & 0xFF);
+  pdu[5] = (uint8_t)(regNum & 0xFF);
+  pdu[6] = (uint8_t)length;
+  memcpy(pdu + 7, data, length);
+  packedCRC(header);
   sendPackage(header);
   header = recvAndParsePackage(id, (uint8_t)eCMD_WRITE_MULTI_COILS, reg, &ret);
   size = 0;
   if((ret == 0) && (header != NULL)){
-    size = (((uint8_t *)header->payload)[2] << 8) | ((uint8_t *)header->payload)[3];
+    pdu = (uint8_t *)&(header->id);
+    size = (pdu[4] << 8) | pdu[5];
     free(header);
   }
   return ret;
 }
+#endif
+#if RTU_ENABLE_FC10
 uint8_t DFRobot_RTU::writeHoldingRegister(uint8_t id, uint16_t reg, void *data, uint16_t size){
-  if(((size % 2) != 0) || (size > 250) || data == NULL) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
-  //#if defined(ESP8266)
-  uint8_t temp[size + 5];
-  temp[0] = (uint8_t)((reg >> 8) & 0xFF);
-  temp[1] = (uint8_t)(reg & 0xFF);
-  temp[2] = (uint8_t)(((size/2) >> 8) & 0xFF);
-  temp[3] = (uint8_t)((size/2) & 0xFF);
-  temp[4] = (uint8_t)size;
-  //#else
-  //uint8_t temp[size + 5] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), (uint8_t)(((size/2) >> 8) & 0xFF), (uint8_t)((size/2) & 0xFF),(uint8_t)size};
-  //#endif
+  pRtuPacketHeader_t header = NULL;
+  uint8_t *pdu = NULL;
   uint8_t ret = 0;
+  if(((size % 2) != 0) || (size > 250) || ((size + 5) > (RTU_MAX_FRAME_SIZE - 4)) || data == NULL) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
   if(id > 0xF7){
     RTU_DBG("Device id error");
     return (uint8_t)eRTU_ID_ERROR;
   }
-  memcpy(temp+5, data, size);
-  pRtuPacketHeader_t header = packed(id, eCMD_WRITE_MULTI_HOLDING, temp, sizeof(temp));
+  if((header = packedAlloc(id, eCMD_WRITE_MULTI_HOLDING, size + 5)) == NULL) return (uint8_t)eRTU_MEMORY_ERROR;
+  pdu = (uint8_t *)&(header->id);
+  pdu[2] = (uint8_t)((reg >> 8) & 0xFF);
+  pdu[3] = (uint8_t)(reg & 0xFF);
+  pdu[4] = (uint8_t)(((size/2) >> 8) & 0xFF);
+  pdu[5] = (uint8_t)((size/2) & 0xFF);
+  pdu[6] = (uint8_t)size;
+  memcpy(pdu + 7, data, size);
+  packedCRC(header);
   sendPackage(header);
   header = recvAndParsePackage(id, (uint8_t)eCMD_WRITE_MULTI_HOLDING, reg, &ret);
   size = 0;
   if((ret == 0) && (header != NULL)){
-    size = (((uint8_t *)header->payload)[2] << 8) | ((uint8_t *)header->payload)[3];
+    pdu = (uint8_t *)&(header->id);
+    size = (pdu[4] << 8) | pdu[5];
     free(header);
   }
   return ret;
 }
+#endif
 
+#if RTU_ENABLE_FC10
 uint8_t DFRobot_RTU::writeHoldingRegister(uint8_t id, uint16_t reg, uint16_t *data, uint16_t regNum){
   uint16_t size = regNum * 2;
-  uint8_t *pBuf = (uint8_t *)data;
-  //#if defined(ESP8266)
-  uint8_t temp[size + 5];
-  temp[0] = (uint8_t)((reg >> 8) & 0xFF);
-  temp[1] = (uint8_t)(reg & 0xFF);
-  temp[2] = (uint8_t)(((size/2) >> 8) & 0xFF);
-  temp[3] = (uint8_t)((size/2) & 0xFF);
-  temp[4] = (uint8_t)size;
-  //#else
-  //uint8_t temp[size + 5] = {(uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), (uint8_t)(((size/2) >> 8) & 0xFF), (uint8_t)((size/2) & 0xFF),(uint8_t)size};
-  //#endif
+  pRtuPacketHeader_t header = NULL;
+  uint8_t *pdu = NULL;
   uint8_t ret = 0;
+  if((size > 250) || ((size + 5) > (RTU_MAX_FRAME_SIZE - 4)) || data == NULL) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
   if(id > 0xF7){
     RTU_DBG("Device id error");
     return (uint8_t)eRTU_ID_ERROR;
   }
-  //memcpy(temp+5, data, size);
+  if((header = packedAlloc(id, eCMD_WRITE_MULTI_HOLDING, size + 5)) == NULL) return (uint8_t)eRTU_MEMORY_ERROR;
+  pdu = (uint8_t *)&(header->id);
+  pdu[2] = (uint8_t)((reg >> 8) & 0xFF);
+  pdu[3] = (uint8_t)(reg & 0xFF);
+  pdu[4] = (uint8_t)((regNum >> 8) & 0xFF);
+  pdu[5] = (uint8_t)(regNum & 0xFF);
+  pdu[6] = (uint8_t)size;
   for(int i = 0; i < regNum; i++){
-    temp[5+i*2] =  pBuf[2*i + 1];
-    temp[6+i*2] =  pBuf[2*i] ;
+    pdu[7+i*2] = (uint8_t)((data[i] >> 8) & 0xFF);
+    pdu[8+i*2] = (uint8_t)(data[i] & 0xFF);
   }
-  pRtuPacketHeader_t header = packed(id, eCMD_WRITE_MULTI_HOLDING, temp, sizeof(temp));
+  packedCRC(header);
   sendPackage(header);
   header = recvAndParsePackage(id, (uint8_t)eCMD_WRITE_MULTI_HOLDING, reg, &ret);
   size = 0;
   if((ret == 0) && (header != NULL)){
-    size = (((uint8_t *)header->payload)[2] << 8) | ((uint8_t *)header->payload)[3];
+    pdu = (uint8_t *)&(header->id);
+    size = (pdu[4] << 8) | pdu[5];
+    free(header);
+  }
+  return ret;
+}
+#endif
+
+#if RTU_ENABLE_FC08
+uint8_t DFRobot_RTU::diagnostics(uint8_t id, uint16_t subFunction, uint16_t *data){
+  uint16_t val = (data != NULL) ? *data : 0;
+  uint8_t temp[] = {(uint8_t)((subFunction >> 8) & 0xFF), (uint8_t)(subFunction & 0xFF), (uint8_t)((val >> 8) & 0xFF), (uint8_t)(val & 0xFF)};
+  uint8_t ret = 0;
+  if((id == 0) || (id > 0xF7)){
+    RTU_DBG("Device id error");
+    return (uint8_t)eRTU_ID_ERROR;
+  }
+  pRtuPacketHeader_t header = packed(id, eCMD_DIAGNOSTICS, temp, sizeof(temp));
+  sendPackage(header);
+  header = recvAndParsePackage(id, (uint8_t)eCMD_DIAGNOSTICS, sizeof(temp), &ret);
+  if(header != NULL){
+    uint8_t *pdu = (uint8_t *)&(header->id);
+    if((ret == 0) && (data != NULL)) *data = (pdu[4] << 8) | pdu[5];
+    free(header);
+  }
+  return ret;
+}
+
+uint8_t DFRobot_RTU::echoDiagnostics(uint8_t id, const uint8_t *data, uint16_t size){
+  pRtuPacketHeader_t header = NULL;
+  uint8_t *pdu = NULL;
+  uint8_t ret = 0;
+  if((data == NULL) || (size == 0) || ((size + 2) > (RTU_MAX_FRAME_SIZE - 4))) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+  if((id == 0) || (id > 0xF7)){
+    RTU_DBG("Device id error");
+    return (uint8_t)eRTU_ID_ERROR;
+  }
+  if((header = packedAlloc(id, eCMD_DIAGNOSTICS, size + 2)) == NULL) return (uint8_t)eRTU_MEMORY_ERROR;
+  pdu = (uint8_t *)&(header->id);
+  pdu[2] = (uint8_t)((eDIAG_RETURN_QUERY_DATA >> 8) & 0xFF);
+  pdu[3] = (uint8_t)(eDIAG_RETURN_QUERY_DATA & 0xFF);
+  memcpy(pdu + 4, data, size);
+  packedCRC(header);
+  sendPackage(header);
+  header = recvAndParsePackage(id, (uint8_t)eCMD_DIAGNOSTICS, size + 2, &ret);
+  if(header != NULL){
+    pdu = (uint8_t *)&(header->id);
+    if((ret == 0) && ((((pdu[2] << 8) | pdu[3]) != eDIAG_RETURN_QUERY_DATA) || (memcmp(pdu + 4, data, size) != 0))) ret = (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+    free(header);
+  }
+  return ret;
+}
+#endif
+
+#if RTU_ENABLE_FC11
+uint8_t DFRobot_RTU::reportServerID(uint8_t id, uint8_t *data, uint8_t *size){
+  uint8_t ret = 0;
+  if((data == NULL) || (size == NULL)) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+  if((id == 0) || (id > 0xF7)){
+    RTU_DBG("Device id error");
+    return (uint8_t)eRTU_ID_ERROR;
+  }
+  pRtuPacketHeader_t header = packed(id, eCMD_REPORT_SERVER_ID, NULL, 0);
+  sendPackage(header);
+  header = recvAndParsePackage(id, (uint8_t)eCMD_REPORT_SERVER_ID, 0, &ret);
+  if(header != NULL){
+    if(ret == 0){
+      uint8_t *pdu = (uint8_t *)&(header->id);
+      if(*size > pdu[2]) *size = pdu[2];
+      memcpy(data, pdu + 3, *size);
+    }
     free(header);
   }
   return ret;
 }
+#endif
+
+#if RTU_ENABLE_FC2B
+uint8_t DFRobot_RTU::readDeviceIdentification(uint8_t id, uint8_t objectId, char *value, uint8_t size){
+  //MEI type 0x0E, read device ID code 0x04: one specific object.
+  uint8_t temp[] = {0x0E, 0x04, objectId};
+  uint8_t *pData = NULL;
+  uint8_t ret = 0;
+  if((value == NULL) || (size == 0)) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+  if((id == 0) || (id > 0xF7)){
+    RTU_DBG("Device id error");
+    return (uint8_t)eRTU_ID_ERROR;
+  }
+  value[0] = '\0';
+  pRtuPacketHeader_t header = packed(id, eCMD_READ_DEVICE_ID, temp, sizeof(temp));
+  sendPackage(header);
+  header = recvAndParsePackage(id, (uint8_t)eCMD_READ_DEVICE_ID, 0, &ret);
+  if(header != NULL){
+    //MEI type, ID code, conformity level, more follows, next object, number of objects, object id, length, value
+    pData = header->payload;
+    if((ret == 0) && ((pData[5] == 0) || (pData[6] != objectId))) ret = (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    if(ret == 0){
+      size = (pData[7] < size) ? pData[7] : (size - 1);
+      memcpy(value, pData + 8, size);
+      value[size] = '\0';
+    }
+    free(header);
+  }
+  return ret;
+}
+#endif
+
+#if RTU_ENABLE_BATCH
+uint8_t DFRobot_RTU::executeBatch(sRtuTransaction_t *list, uint16_t num, sRtuResult_t *result, bool stopOnError){
+  uint8_t frame[RTU_MAX_FRAME_SIZE];
+  uint8_t first = 0, ret = 0;
+  uint16_t length = 0, data = 0;
+  uint32_t start = 0;
+  if(list == NULL) return (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+  for(uint16_t i = 0; i < num; i++){
+    sRtuTransaction_t *t = &list[i];
+    if((first != 0) && stopOnError){
+      if(result != NULL){
+        result[i].status = (uint8_t)eRTU_NOT_EXECUTED;
+        result[i].latency = 0;
+      }
+      continue;
+    }
+    start = micros();
+    if((length = packRequest(frame, t, &data, &ret)) != 0){
+      //Only the t3.5 gap between frames, no delay per stale byte as in clearRecvBuffer().
+      if(waitFrameGap() != 0){
+        ret = (uint8_t)eRTU_NOT_EXECUTED;
+      }else{
+        start = micros();
+        sendFrame(frame, length);
+      }
+      if((ret == 0) && (t->id != RTU_BROADCAST_ADDRESS)){
+        length = recvFrame(frame, t->id, t->cmd, data, &ret);
+        if((ret == 0) && (t->data != NULL) && (t->cmd <= eCMD_READ_INPUT)){
+          if((t->cmd == eCMD_READ_COILS) || (t->cmd == eCMD_READ_DISCRETE)){
+            memcpy(t->data, frame + 3, data);
+          }else{
+            for(uint16_t j = 0; j < t->num; j++){
+              ((uint16_t *)t->data)[j] = (frame[3 + 2*j] << 8) | frame[4 + 2*j];
+            }
+          }
+        }
+      }
+    }
+    if(result != NULL){
+      result[i].status = ret;
+      result[i].latency = micros() - start;
+    }
+    if((ret != 0) && (first == 0)) first = ret;
+  }
+  return first;
+}
+
+uint16_t DFRobot_RTU::packRequest(uint8_t *frame, const sRtuTransaction_t *t, uint16_t *data, uint8_t *error){
+  uint16_t length = 6, count = 0, crc = 0;
+  uint16_t val = 0;
+  *error = (uint8_t)eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+  //Nobody answers a broadcast, so a broadcast read can not return any data.
+  if((t->id > 0xF7) || ((t->id == RTU_BROADCAST_ADDRESS) && (t->cmd <= eCMD_READ_INPUT))){
+    *error = (uint8_t)eRTU_ID_ERROR;
+    return 0;
+  }
+  frame[0] = t->id;
+  frame[1] = t->cmd;
+  frame[2] = (uint8_t)((t->reg >> 8) & 0xFF);
+  frame[3] = (uint8_t)(t->reg & 0xFF);
+  frame[4] = (uint8_t)((t->num >> 8) & 0xFF);
+  frame[5] = (uint8_t)(t->num & 0xFF);
+  *data = t->reg;
+  switch(t->cmd){
+#if RTU_ENABLE_FC01 || RTU_ENABLE_FC02
+#if RTU_ENABLE_FC01
+    case eCMD_READ_COILS:
+#endif
+#if RTU_ENABLE_FC02
+    case eCMD_READ_DISCRETE:
+#endif
+      if((t->num == 0) || (t->num > 2000)) return 0;
+      *data = (t->num + 7) / 8;
+      break;
+#endif
+#if RTU_ENABLE_FC03 || RTU_ENABLE_FC04
+#if RTU_ENABLE_FC03
+    case eCMD_READ_HOLDING:
+#endif
+#if RTU_ENABLE_FC04
+    case eCMD_READ_INPUT:
+#endif
+      if((t->num == 0) || (t->num > 125)) return 0;
+      *data = t->num * 2;
+      break;
+#endif
+#if RTU_ENABLE_FC05
+    case eCMD_WRITE_COILS:
+      if(t->data == NULL) return 0;
+      val = (((uint8_t *)t->data)[0] & 0x01) ? 0xFF00 : 0x0000;
+      frame[4] = (uint8_t)((val >> 8) & 0xFF);
+      frame[5] = (uint8_t)(val & 0xFF);
+      break;
+#endif
+#if RTU_ENABLE_FC06
+    case eCMD_WRITE_HOLDING:
+      if(t->data == NULL) return 0;
+      val = ((uint16_t *)t->data)[0];
+      frame[4] = (uint8_t)((val >> 8) & 0xFF);
+      frame[5] = (uint8_t)(val & 0xFF);
+      break;
+#endif
+#if RTU_ENABLE_FC0F
+    case eCMD_WRITE_MULTI_COILS:
+      count = (t->num + 7) / 8;
+      if((t->data == NULL) || (t->num == 0) || (t->num > 1968) || ((count + 9) > RTU_MAX_FRAME_SIZE)) return 0;
+      frame[6] = (uint8_t)count;
+      memcpy(frame + 7, t->data, count);
+      length = 7 + count;
+      break;
+#endif
+#if RTU_ENABLE_FC10
+    case eCMD_WRITE_MULTI_HOLDING:
+      count = t->num * 2;
+      if((t->data == NULL) || (t->num == 0) || (t->num > 123) || ((count + 9) > RTU_MAX_FRAME_SIZE)) return 0;
+      frame[6] = (uint8_t)count;
+      for(uint16_t i = 0; i < t->num; i++){
+        val = ((uint16_t *)t->data)[i];
+        frame[7 + 2*i] = (uint8_t)((val >> 8) & 0xFF);
+        frame[8 + 2*i] = (uint8_t)(val & 0xFF);
+      }
+      length = 7 + count;
+      break;
+#endif
+    default:
+      *error = (uint8_t)eRTU_EXCEPTION_ILLEGAL_FUNCTION;
+      return 0;
+  }
+  if(checkFrame(NULL, 0, t->id, t->cmd, *data) > RTU_MAX_FRAME_SIZE) return 0;
+  crc = calculateCRC(frame, length);
+  frame[length++] = (crc >> 8) & 0xFF;
+  frame[length++] = crc & 0xFF;
+  *error = 0;
+  return length;
+}
+#endif
 
 DFRobot_RTU::pRtuPacketHeader_t DFRobot_RTU::packed(uint8_t id, eFunctionCommand_t cmd, void *data, uint16_t size){
   return packed(id, (uint8_t)cmd, data, size);
@@ -383,8 +744,15 @@ DFRobot_RTU::pRtuPacketHeader_t DFRobot_RTU::packed(uint8_t id, eFunctionCommand
 
 DFRobot_RTU::pRtuPacketHeader_t DFRobot_RTU::packed(uint8_t id, uint8_t cmd, void *data, uint16_t size){
   pRtuPacketHeader_t header = NULL;
-  uint16_t crc = 0;
-  if((data == NULL) || (size == 0)) return NULL;
+  if((data == NULL) && (size != 0)) return NULL;
+  if((header = packedAlloc(id, cmd, size)) == NULL) return NULL;
+  if(size != 0) memcpy(header->payload, data, size);
+  packedCRC(header);
+  return header;
+}
+
+DFRobot_RTU::pRtuPacketHeader_t DFRobot_RTU::packedAlloc(uint8_t id, uint8_t cmd, uint16_t size){
+  pRtuPacketHeader_t header = NULL;
   if((header = (pRtuPacketHeader_t)malloc(sizeof(sRtuPacketHeader_t) + size)) == NULL){
     RTU_DBG("Memory ERROR");
     return NULL;
@@ -392,28 +760,37 @@ DFRobot_RTU::pRtuPacketHeader_t DFRobot_RTU::packed(uint8_t id, uint8_t cmd, voi
   header->len = sizeof(sRtuPacketHeader_t) + size - 2;
   header->id = id;
   header->cmd = cmd;
-  memcpy(header->payload, data, size);
-  crc = calculateCRC((uint8_t *)&(header->id), (header->len) - 2);
-  ((uint8_t *)header->payload)[size] = (crc >> 8) & 0xFF;
-  ((uint8_t *)header->payload)[size+1] = crc & 0xFF;
   return header;
 }
 
+void DFRobot_RTU::packedCRC(pRtuPacketHeader_t header){
+  //The CRC follows the payload, addressed from the ID as the payload array has no size.
+  uint8_t *frame = (uint8_t *)&(header->id);
+  uint16_t crc = calculateCRC(frame, (header->len) - 2);
+  frame[header->len - 2] = (crc >> 8) & 0xFF;
+  frame[header->len - 1] = crc & 0xFF;
+}
+
 void DFRobot_RTU::sendPackage(pRtuPacketHeader_t header){
   clearRecvBuffer();
   if(header != NULL){
-    if(_dePin>0){
-      digitalWrite(_dePin,HIGH);
-      delayMicroseconds(50);
-    }
-    _s->write((uint8_t *)&(header->id), header->len);
-    _s->flush();
-    
+    sendFrame((uint8_t *)&(header->id), header->len);
     free(header);
-    if(_dePin>0){
-      //delayMicroseconds(50);
-      digitalWrite(_dePin,LOW);
-    }
+  }
+}
+
+void DFRobot_RTU::sendFrame(uint8_t *frame, uint16_t len){
+  if(_dePin>0){
+    digitalWrite(_dePin,HIGH);
+    delayMicroseconds(50);
+  }
+  _s->write(frame, len);
+  _s->flush();
+  _lastUs = micros();
+  RTU_STAT(request);
+  if(_dePin>0){
+    //delayMicroseconds(50);
+    digitalWrite(_dePin,LOW);
   }
 }
 
@@ -424,121 +801,179 @@ DFRobot_RTU::pRtuPacketHeader_t DFRobot_RTU::recvAndParsePackage(uint8_t id, uin
     return NULL;
   }
   
-  uint8_t head[4] = {0, 0, 0, 0};
-  uint16_t crc = 0;
+  uint16_t size = checkFrame(NULL, 0, id, cmd, data);
   pRtuPacketHeader_t header = NULL;
-  //uint8_t timeInterMs = 5;
 
-LOOP:
-  uint16_t remain, index = 0;
+  if((size > RTU_MAX_FRAME_SIZE) || ((header = (pRtuPacketHeader_t)malloc(size+2)) == NULL)){
+    RTU_DBG("Memory ERROR");
+    if(error != NULL) *error = eRTU_RECV_ERROR;
+    return NULL;
+  }
+  if((header->len = recvFrame((uint8_t *)&(header->id), id, cmd, data, error)) == 0){
+    free(header);
+    return NULL;
+  }
+  return header;
+}
+
+uint16_t DFRobot_RTU::recvFrame(uint8_t *frame, uint8_t id, uint8_t cmd, uint16_t data, uint8_t *error){
+  uint16_t index = 0, length = 0;
+  uint16_t crc = 0;
+  bool crcError = false;
   uint32_t time = millis();
-  for(int i = 0; i < 4;){
+
+  //The frame holds a window of the received bytes that may still be the beginning of the answer.
+  while(1){
     if(_s->available()){
-      head[index++] = (uint8_t)_s->read();
-      RTU_DBG(head[index-1],HEX);
-      if((index == 1) && (head[0] != id)){
-        index = 0;
-      }else if((index == 2) && ((head[1]&0x7F) != cmd)){
-        index = 0;
-      }
-      i = index;
+      frame[index++] = (uint8_t)_s->read();
+      _lastUs = micros();
+      RTU_DBG(frame[index-1],HEX);
       time = millis();
-    }
-    if((millis() - time) > _timeout) {
+      crcError = false;
+    }else if((millis() - time) <= ((crcError && (index == 0) && (_timeout > RTU_RESYNC_TIMEOUT)) ? RTU_RESYNC_TIMEOUT : _timeout)){
+      //After a CRC error nothing is left to wait for, unless the answer follows the bad bytes immediately.
+      continue;
+    }else if(index == 0){
       RTU_DBG("ERROR");
       RTU_DBG(millis() - time);
-      break;
+      RTU_STAT(timeout);
+      if(error != NULL) *error = eRTU_RECV_ERROR;
+      return 0;
+    }else{
+      //The candidate never completed(a stale byte count or echo), a whole answer may follow its first byte.
+      memmove(frame, frame + 1, --index);
+    }
+    while(index){
+      length = checkFrame(frame, index, id, cmd, data);
+      if((length != 0) && (index < length)) break;
+      //More bytes than the answer only remain after a timeout slide, the rest of the window is dropped.
+      if(length != 0){
+        crc = (frame[length-2] << 8) | frame[length-1];
+        if(crc == calculateCRC(frame, length - 2)) break;
+        RTU_DBG("CRC ERROR");
+        RTU_STAT(crcError);
+        crcError = true;
+      }
+      //Not the answer, slide the window by one byte and check again, a glitch byte costs no timeout.
+      memmove(frame, frame + 1, --index);
     }
+    if((index != 0) && (index >= length)) break;
   }
+  if(error != NULL) *error = 0;
+  RTU_STAT(answer);
+  if(frame[1] & 0x80){
+    RTU_STAT(exception);
+    if(error != NULL) *error = frame[2];
+  }
+  return length;
+}
 
-  if(index != 4) {
-    RTU_DBG();
-    if(error != NULL) *error = eRTU_RECV_ERROR;
-    return NULL;
+uint8_t DFRobot_RTU::waitFrameGap(){
+  uint32_t time = millis();
+  //Stale bytes restart the silence, it ends t3.5 after the last of them. A device that never stops talking times out.
+  while(((micros() - _lastUs) < _t35Us) || _s->available()){
+    if((millis() - time) > _timeout){
+      RTU_DBG("Bus not silent");
+      return (uint8_t)eRTU_RECV_ERROR;
+    }
+    if(_s->available()){
+      _s->read();
+      _lastUs = micros();
+    }
+  }
+  return 0;
+}
+
+uint16_t DFRobot_RTU::checkFrame(uint8_t *frame, uint16_t len, uint8_t id, uint8_t cmd, uint16_t data){
+  uint16_t size = 5;
+  switch(cmd){
+    case eCMD_READ_COILS:
+    case eCMD_READ_DISCRETE:
+    case eCMD_READ_HOLDING:
+    case eCMD_READ_INPUT:
+      size = 5 + (data & 0xFF);
+      break;
+    case eCMD_WRITE_COILS:
+    case eCMD_WRITE_HOLDING:
+    case eCMD_WRITE_MULTI_COILS:
+    case eCMD_WRITE_MULTI_HOLDING:
+      size = 8;
+      break;
+    case eCMD_DIAGNOSTICS:
+      size = 4 + data;
+      break;
+    case eCMD_REPORT_SERVER_ID:
+    case eCMD_READ_DEVICE_ID:
+      size = RTU_MAX_FRAME_SIZE;
+      break;
+    default:
+      break;
   }
-  switch(head[1]){
+  if(frame == NULL) return (size > 5) ? size : 5;
+  if((len >= 1) && (frame[0] != id)) return 0;
+  if((len >= 2) && ((frame[1] & 0x7F) != cmd)) return 0;
+  if((len < 2) || (frame[1] & 0x80)) return 5;
+  switch(cmd){
     case eCMD_READ_COILS:
     case eCMD_READ_DISCRETE:
     case eCMD_READ_HOLDING:
     case eCMD_READ_INPUT:
-      if(head[2] != (data & 0xFF)) {
-        index = 0;
-        goto LOOP;
-      }
-      index = 5 + head[2];
+      if((len >= 3) && (frame[2] != (data & 0xFF))) return 0;
       break;
     case eCMD_WRITE_COILS:
     case eCMD_WRITE_HOLDING:
     case eCMD_WRITE_MULTI_COILS:
     case eCMD_WRITE_MULTI_HOLDING:
-      if(((head[2] << 8) | (head[3])) != data){
-        index = 0;
-        goto LOOP;
+      if((len >= 4) && (((frame[2] << 8) | frame[3]) != data)) return 0;
+      break;
+    case eCMD_REPORT_SERVER_ID:
+      if(len >= 3) size = 5 + frame[2];
+      break;
+    case eCMD_READ_DEVICE_ID:
+      if((len >= 3) && (frame[2] != 0x0E)) return 0;
+      if(len < 8) break;
+      //No byte count, walk the objects(id, length, value) as they arrive.
+      size = 8;
+      for(uint8_t i = 0; i < frame[7]; i++){
+        if(len < (size + 2)){
+          size = RTU_MAX_FRAME_SIZE - 2;
+          break;
+        }
+        size += 2 + frame[size + 1];
       }
-      index = 8;
+      size += 2;
       break;
     default:
-      index = 5;
       break;
   }
-  if((header = (pRtuPacketHeader_t)malloc(index+2)) == NULL){
-    RTU_DBG("Memory ERROR");
-    if(error != NULL) *error = eRTU_RECV_ERROR;
-    return NULL;
-  }
-  header->len = index;
-  memcpy((uint8_t *)&(header->id), head, 4);
-  remain = index - 4;
-  index = 2;
-  time = millis();
-  while(remain){
-    RTU_DBG(_s->available());
-    if(_s->available()){
-      *(header->payload+index) = (uint8_t)_s->read();
-      index++;
-      time = millis();
-      remain--;
-    }
-    if((millis() - time) > _timeout) {
-      free(header);
-      if(error != NULL) *error = eRTU_RECV_ERROR;
-      RTU_DBG();
-      return NULL;
-    }
-  }
-  crc = (((uint8_t *)header->payload)[(header->len)-4] << 8) | ((uint8_t *)header->payload)[(header->len)-3];
+  if(size > RTU_MAX_FRAME_SIZE) return 0;
+  return size;
+}
 
-  if(crc != calculateCRC((uint8_t *)&(header->id), (header->len) - 2)){
-    free(header);
-    RTU_DBG("CRC ERROR");
-    if(error != NULL) *error = eRTU_RECV_ERROR;
-    return NULL;
-  }
-  if(error != NULL) *error = 0;
-  if(head[1] & 0x80){
-    *error = head[2];
+uint16_t DFRobot_RTU::calculateCRC(uint8_t *data, uint16_t len){
+  uint16_t crc = 0xFFFF;
+  for( uint16_t pos = 0; pos < len; pos++){
+    crc = updateCRC(crc, data[ pos ]);
   }
-  
-  return header;
-
+  crc = ((crc & 0x00FF) << 8) | ((crc & 0xFF00) >> 8);
+  return crc;
 }
 
-
-uint16_t DFRobot_RTU::calculateCRC(uint8_t *data, uint8_t len){
-  uint16_t crc = 0xFFFF;
-  for( uint8_t pos = 0; pos < len; pos++){
-    crc ^= (uint16_t)data[ pos ];
-    for(uint8_t i = 8; i != 0; i--){
-      if((crc & 0x0001) != 0){
-        crc >>= 1;
-        crc ^= 0xA001;
-      }else{
-         crc >>= 1;
-      }
+uint16_t DFRobot_RTU::updateCRC(uint16_t crc, uint8_t data){
+#if RTU_CRC_TABLE
+  return (crc >> 8) ^ RTU_CRC_TABLE_READ((crc ^ data) & 0xFF);
+#else
+  crc ^= (uint16_t)data;
+  for(uint8_t i = 8; i != 0; i--){
+    if((crc & 0x0001) != 0){
+      crc >>= 1;
+      crc ^= 0xA001;
+    }else{
+       crc >>= 1;
     }
   }
-  crc = ((crc & 0x00FF) << 8) | ((crc & 0xFF00) >> 8);
   return crc;
+#endif
 }
 
 void DFRobot_RTU::clearRecvBuffer(){
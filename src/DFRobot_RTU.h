@@ -19,6 +19,7 @@
 #endif
 
 #include<Stream.h>
+#include "DFRobot_RTU_Config.h"
 
 //Define RTU_DBG, change 0 to 1 open the RTU_DBG, 1 to 0 to close.  
 #if 0
@@ -32,16 +33,18 @@
 #define RTU_BROADCAST_ADDRESS                      0x00 /**<modbus RTU协议的广播地址为0x00*/
 #endif
 
-class DFRobot_RTU{
-protected:
-typedef struct{
-  uint16_t len;
-  uint8_t id;
-  uint8_t cmd;
-  uint8_t payload[0];
-  uint16_t cs;
-}__attribute__ ((packed)) sRtuPacketHeader_t, *pRtuPacketHeader_t;
+#ifndef RTU_RESYNC_TIMEOUT
+#define RTU_RESYNC_TIMEOUT                         5    /**<ms to wait for more bytes after a CRC error, longer than t3.5 at 9600*/
+#endif
+
+//Limited by the protocol and by RTU_MAX_FRAME_SIZE.
+#define RTU_MAX_READ_REGISTERS                     (((RTU_MAX_FRAME_SIZE - 5) / 2) < 125 ? ((RTU_MAX_FRAME_SIZE - 5) / 2) : 125) /**<Max number of registers of one FC03/FC04 request*/
+#define RTU_MAX_WRITE_REGISTERS                    (((RTU_MAX_FRAME_SIZE - 9) / 2) < 123 ? ((RTU_MAX_FRAME_SIZE - 9) / 2) : 123) /**<Max number of registers of one FC10 request*/
+#define RTU_MAX_READ_COILS                         (((RTU_MAX_FRAME_SIZE - 5) * 8) < 2000 ? ((RTU_MAX_FRAME_SIZE - 5) * 8) : 2000) /**<Max number of coils of one FC01/FC02 request, a multiple of 8*/
+#define RTU_MAX_WRITE_COILS                        (((RTU_MAX_FRAME_SIZE - 9) * 8) < 1968 ? ((RTU_MAX_FRAME_SIZE - 9) * 8) : 1968) /**<Max number of coils of one FC0F request*/
 
+class DFRobot_RTU{
+public:
 typedef enum{
   eRTU_EXCEPTION_ILLEGAL_FUNCTION = 0x01,
   eRTU_EXCEPTION_ILLEGAL_DATA_ADDRESS,
@@ -50,7 +53,8 @@ typedef enum{
   eRTU_EXCEPTION_CRC_ERROR = 0x08,
   eRTU_RECV_ERROR,
   eRTU_MEMORY_ERROR,
-  eRTU_ID_ERROR
+  eRTU_ID_ERROR,
+  eRTU_NOT_EXECUTED
 }eRtuStatusExceptionCode_t;
 
 typedef enum{
@@ -60,16 +64,100 @@ typedef enum{
   eCMD_READ_INPUT  = 0x04,
   eCMD_WRITE_COILS = 0x05,
   eCMD_WRITE_HOLDING  = 0x06,
+  eCMD_DIAGNOSTICS = 0x08,
   eCMD_WRITE_MULTI_COILS = 0x0F,
-  eCMD_WRITE_MULTI_HOLDING  = 0x10
+  eCMD_WRITE_MULTI_HOLDING  = 0x10,
+  eCMD_REPORT_SERVER_ID = 0x11,
+  eCMD_READ_DEVICE_ID = 0x2B
 }eFunctionCommand_t;
 
+#if RTU_ENABLE_FC08
+typedef enum{
+  eDIAG_RETURN_QUERY_DATA = 0x00,      /**<Echo the data of the request*/
+  eDIAG_RESTART_COMMUNICATIONS = 0x01, /**<Restart the serial line, data 0xFF00 also clears the event log*/
+  eDIAG_CLEAR_COUNTERS = 0x0A,         /**<Clear all counters below*/
+  eDIAG_BUS_MESSAGE_COUNT = 0x0B,      /**<Messages seen on the bus*/
+  eDIAG_BUS_CRC_ERROR_COUNT = 0x0C,    /**<Messages with a CRC error*/
+  eDIAG_BUS_EXCEPTION_COUNT = 0x0D,    /**<Exception answers of the slave*/
+  eDIAG_SLAVE_MESSAGE_COUNT = 0x0E,    /**<Messages addressed to the slave*/
+  eDIAG_SLAVE_NO_RESPONSE_COUNT = 0x0F,/**<Messages not answered, such as broadcasts*/
+  eDIAG_SLAVE_NAK_COUNT = 0x10,        /**<Negative acknowledge answers*/
+  eDIAG_SLAVE_BUSY_COUNT = 0x11,       /**<Slave device busy answers*/
+  eDIAG_BUS_OVERRUN_COUNT = 0x12       /**<Characters lost by overrun*/
+}eRtuDiagnosticsCode_t;
+#endif
+
+typedef struct{
+  uint32_t request;   /**<Requests sent*/
+  uint32_t answer;    /**<Answers received with a correct CRC, including exceptions*/
+  uint32_t exception; /**<Exception answers*/
+  uint32_t timeout;   /**<Requests without a correct answer before the timeout*/
+  uint32_t crcError;  /**<Candidate answers with a wrong CRC*/
+}sRtuStatistics_t;
+
+#if RTU_ENABLE_BATCH
+typedef struct{
+  uint8_t id;        /**<modbus device ID, 0 is the broadcast address*/
+  uint8_t cmd;       /**<Function code, eFunctionCommand_t*/
+  uint16_t reg;      /**<Address of the first coil or register*/
+  uint16_t num;      /**<Number of coils or registers, 1 for FC05 and FC06*/
+  void *data;        /**<Coils: packed bits, LSB of the first byte is the first coil. Registers: uint16_t array. NULL discards read data*/
+}sRtuTransaction_t;
+
+typedef struct{
+  uint8_t status;    /**<Exception code of the transaction, 0: sucess, eRTU_NOT_EXECUTED: skipped after an error*/
+  uint32_t latency;  /**<us from the start of the request to the end of the answer*/
+}__attribute__ ((packed)) sRtuResult_t;
+#endif
+
+protected:
+typedef struct{
+  uint16_t len;
+  uint8_t id;
+  uint8_t cmd;
+  uint8_t payload[0];
+  uint16_t cs;
+}__attribute__ ((packed)) sRtuPacketHeader_t, *pRtuPacketHeader_t;
+
   void clearRecvBuffer();
-  uint16_t calculateCRC(uint8_t *data, uint8_t len);
   pRtuPacketHeader_t packed(uint8_t id, eFunctionCommand_t cmd, void *data, uint16_t size);
   pRtuPacketHeader_t packed(uint8_t id, uint8_t cmd, void *data, uint16_t size);
+/**
+ * @brief Allocate a request of size payload bytes, the caller writes the payload in place and calls packedCRC().
+ * @return The request, NULL: Memory error.
+ */
+  pRtuPacketHeader_t packedAlloc(uint8_t id, uint8_t cmd, uint16_t size);
+  void packedCRC(pRtuPacketHeader_t header);
   void sendPackage(pRtuPacketHeader_t header);
+  void sendFrame(uint8_t *frame, uint16_t len);
   pRtuPacketHeader_t recvAndParsePackage(uint8_t id, uint8_t cmd, uint16_t data, uint8_t *error);
+/**
+ * @brief Receive the answer of a request into a buffer, bytes which can not be the answer are skipped. When the
+ * @n     timeout expires on a candidate that never completed, the answer is still searched after its first byte.
+ * @param frame: Buffer of at least checkFrame(NULL, ...) bytes, the answer starts from the ID.
+ * @param id, cmd, data: The same as checkFrame.
+ * @param error: Exception code of the answer, eRTU_RECV_ERROR on timeout, it can be NULL.
+ * @return The length of the answer, 0: no answer.
+ */
+  uint16_t recvFrame(uint8_t *frame, uint8_t id, uint8_t cmd, uint16_t data, uint8_t *error);
+/**
+ * @brief Wait until the bus has been silent for t3.5, stale bytes received meanwhile are discarded. The wait is
+ * @n     bounded by the timeout of setTimeoutTimeMs().
+ * @return 0: The bus is silent, eRTU_RECV_ERROR: bytes kept arriving until the timeout.
+ */
+  uint8_t waitFrameGap();
+/**
+ * @brief Check whether the received bytes can be the beginning of the answer of a request.
+ * @param frame: The received bytes, NULL to get the max length of the answer.
+ * @param len: Number of received bytes.
+ * @param id: modbus device ID of the request.
+ * @param cmd: Function code of the request.
+ * @param data: Expected byte count of a read answer, the address of a write answer, or the bytes after the function
+ * @n           code of a diagnostics answer. The answers of FC11 and FC2B carry their own length.
+ * @return 0: Not the answer, others: The length of the whole answer, including the CRC, RTU_MAX_FRAME_SIZE while
+ * @n      the length of a variable answer is not received yet.
+ */
+  uint16_t checkFrame(uint8_t *frame, uint16_t len, uint8_t id, uint8_t cmd, uint16_t data);
 public:
 /**
  * @brief DFRobot_RTU abstract class constructor. Construct serial port.
@@ -87,6 +175,32 @@ public:
  */
   void setTimeoutTimeMs(uint32_t timeout = 100);
 
+/**
+ * @brief Get the receive timeout time.
+ * @return receive timeout time, unit ms.
+ */
+  uint32_t getTimeoutTimeMs();
+
+/**
+ * @brief Set the bus baudrate, which is used to calculate the t3.5 frame gap.
+ * @param baud: The baudrate of the serial port, default 9600.
+ */
+  void setBaudrate(uint32_t baud = 9600);
+
+#if RTU_ENABLE_STATISTICS
+/**
+ * @brief Get the bus statistics since the last clearStatistics(), RTU_ENABLE_STATISTICS must be 1.
+ * @param stat: Storage of the statistics.
+ */
+  void getStatistics(sRtuStatistics_t *stat);
+
+/**
+ * @brief Clear the bus statistics.
+ */
+  void clearStatistics();
+#endif
+
+#if RTU_ENABLE_FC01
 /**
  * @brief Read a coils Register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -97,6 +211,8 @@ public:
  * @n      false: The value of the coils register value is 0.
  */
   bool readCoilsRegister(uint8_t id, uint16_t reg);
+#endif
+#if RTU_ENABLE_FC02
 /**
  * @brief Read a discrete input register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -106,6 +222,8 @@ public:
  * @n      false: The value of the coils register value is 0.
  */
   bool readDiscreteInputsRegister(uint8_t id, uint16_t reg);
+#endif
+#if RTU_ENABLE_FC03
 /**
  * @brief Read a holding Register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -114,7 +232,9 @@ public:
  * @return Return the value of the holding register value.
  */
   uint16_t readHoldingRegister(uint8_t id, uint16_t reg);
+#endif
 
+#if RTU_ENABLE_FC04
 /**
  * @brief Read a input Register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -123,6 +243,8 @@ public:
  * @return Return the value of the input register value.
  */
   uint16_t readInputRegister(uint8_t id, uint16_t reg);
+#endif
+#if RTU_ENABLE_FC05
 /**
  * @brief Write a coils Register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -141,6 +263,8 @@ public:
  * @n      11 or eRTU_ID_ERROR: Broadcasr address or error ID
  */
   uint8_t writeCoilsRegister(uint8_t id, uint16_t reg, bool flag);
+#endif
+#if RTU_ENABLE_FC06
 /**
  * @brief Write a holding register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -159,7 +283,9 @@ public:
  * @n      11 or eRTU_ID_ERROR: Broadcasr address or error ID
  */
   uint8_t writeHoldingRegister(uint8_t id, uint16_t reg, uint16_t val);
+#endif
 
+#if RTU_ENABLE_FC01
 /**
  * @brief Read multiple coils Register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -172,7 +298,7 @@ public:
  * @n      0 : sucess.
  * @n      1 or eRTU_EXCEPTION_ILLEGAL_FUNCTION : Illegal function.
  * @n      2 or eRTU_EXCEPTION_ILLEGAL_DATA_ADDRESS: Illegal data address.
- * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE:  Illegal data value.
+ * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE:  Illegal data value, also 0 or more than RTU_MAX_READ_COILS items, refused before sending.
  * @n      4 or eRTU_EXCEPTION_SLAVE_FAILURE:  Slave failure.
  * @n      8 or eRTU_EXCEPTION_CRC_ERROR:  CRC check error.
  * @n      9 or eRTU_RECV_ERROR:  Receive packet error.
@@ -180,6 +306,8 @@ public:
  * @n      11 or eRTU_ID_ERROR: Broadcasr address or error ID
  */
   uint8_t readCoilsRegister(uint8_t id, uint16_t reg, uint16_t regNum, uint8_t *data, uint16_t size);
+#endif
+#if RTU_ENABLE_FC02
 /**
  * @brief Read multiple discrete inputs register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -192,7 +320,7 @@ public:
  * @n      0 : sucess.
  * @n      1 or eRTU_EXCEPTION_ILLEGAL_FUNCTION : Illegal function.
  * @n      2 or eRTU_EXCEPTION_ILLEGAL_DATA_ADDRESS: Illegal data address.
- * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE:  Illegal data value.
+ * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE:  Illegal data value, also 0 or more than RTU_MAX_READ_COILS items, refused before sending.
  * @n      4 or eRTU_EXCEPTION_SLAVE_FAILURE:  Slave failure.
  * @n      8 or eRTU_EXCEPTION_CRC_ERROR:  CRC check error.
  * @n      9 or eRTU_RECV_ERROR:  Receive packet error.
@@ -200,6 +328,8 @@ public:
  * @n      11 or eRTU_ID_ERROR: Broadcasr address or error ID
  */
   uint8_t readDiscreteInputsRegister(uint8_t id, uint16_t reg, uint16_t regNum, uint8_t *data, uint16_t size);
+#endif
+#if RTU_ENABLE_FC03
 /**
  * @brief Read multiple Holding register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -211,7 +341,7 @@ public:
  * @n      0 : sucess.
  * @n      1 or eRTU_EXCEPTION_ILLEGAL_FUNCTION : Illegal function.
  * @n      2 or eRTU_EXCEPTION_ILLEGAL_DATA_ADDRESS: Illegal data address.
- * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE:  Illegal data value.
+ * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE:  Illegal data value, also 0 or more than RTU_MAX_READ_REGISTERS items, refused before sending.
  * @n      4 or eRTU_EXCEPTION_SLAVE_FAILURE:  Slave failure.
  * @n      8 or eRTU_EXCEPTION_CRC_ERROR:  CRC check error.
  * @n      9 or eRTU_RECV_ERROR:  Receive packet error.
@@ -219,7 +349,9 @@ public:
  * @n      11 or eRTU_ID_ERROR: Broadcasr address or error ID
  */
   uint8_t readHoldingRegister(uint8_t id, uint16_t reg, void *data, uint16_t size);
+#endif
 
+#if RTU_ENABLE_FC04
 /**
  * @brief Read multiple Input register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -231,7 +363,7 @@ public:
  * @n      0 : sucess.
  * @n      1 or eRTU_EXCEPTION_ILLEGAL_FUNCTION : Illegal function.
  * @n      2 or eRTU_EXCEPTION_ILLEGAL_DATA_ADDRESS: Illegal data address.
- * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE:  Illegal data value.
+ * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE:  Illegal data value, also 0 or more than RTU_MAX_READ_REGISTERS items, refused before sending.
  * @n      4 or eRTU_EXCEPTION_SLAVE_FAILURE:  Slave failure.
  * @n      8 or eRTU_EXCEPTION_CRC_ERROR:  CRC check error.
  * @n      9 or eRTU_RECV_ERROR:  Receive packet error.
@@ -239,6 +371,8 @@ public:
  * @n      11 or eRTU_ID_ERROR: Broadcasr address or error ID
  */
   uint8_t readInputRegister(uint8_t id, uint16_t reg, void *data, uint16_t size);
+#endif
+#if RTU_ENABLE_FC03
 /**
  * @brief Read multiple Holding register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -250,7 +384,7 @@ public:
  * @n      0 : sucess.
  * @n      1 or eRTU_EXCEPTION_ILLEGAL_FUNCTION : Illegal function.
  * @n      2 or eRTU_EXCEPTION_ILLEGAL_DATA_ADDRESS: Illegal data address.
- * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE:  Illegal data value.
+ * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE:  Illegal data value, also 0 or more than RTU_MAX_READ_REGISTERS items, refused before sending.
  * @n      4 or eRTU_EXCEPTION_SLAVE_FAILURE:  Slave failure.
  * @n      8 or eRTU_EXCEPTION_CRC_ERROR:  CRC check error.
  * @n      9 or eRTU_RECV_ERROR:  Receive packet error.
@@ -258,7 +392,9 @@ public:
  * @n      11 or eRTU_ID_ERROR: Broadcasr address or error ID
  */
   uint8_t readHoldingRegister(uint8_t id, uint16_t reg, uint16_t *data, uint16_t regNum);
+#endif
 
+#if RTU_ENABLE_FC04
 /**
  * @brief Read multiple Input register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -270,7 +406,7 @@ public:
  * @n      0 : sucess.
  * @n      1 or eRTU_EXCEPTION_ILLEGAL_FUNCTION : Illegal function.
  * @n      2 or eRTU_EXCEPTION_ILLEGAL_DATA_ADDRESS: Illegal data address.
- * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE:  Illegal data value.
+ * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE:  Illegal data value, also 0 or more than RTU_MAX_READ_REGISTERS items, refused before sending.
  * @n      4 or eRTU_EXCEPTION_SLAVE_FAILURE:  Slave failure.
  * @n      8 or eRTU_EXCEPTION_CRC_ERROR:  CRC check error.
  * @n      9 or eRTU_RECV_ERROR:  Receive packet error.
@@ -278,7 +414,9 @@ public:
  * @n      11 or eRTU_ID_ERROR: Broadcasr address or error ID
  */
   uint8_t readInputRegister(uint8_t id, uint16_t reg, uint16_t *data, uint16_t regNum);
+#endif
   
+#if RTU_ENABLE_FC0F
 /**
  * @brief Write multiple coils Register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -299,6 +437,8 @@ public:
  * @n      11 or eRTU_ID_ERROR: Broadcasr address or error ID
  */
   uint8_t writeCoilsRegister(uint8_t id, uint16_t reg, uint16_t regNum, uint8_t *data, uint16_t size);
+#endif
+#if RTU_ENABLE_FC10
 /**
  * @brief Write multiple Holding Register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -318,6 +458,8 @@ public:
  * @n      11 or eRTU_ID_ERROR: Broadcasr address or error ID
  */
   uint8_t writeHoldingRegister(uint8_t id, uint16_t reg, void *data, uint16_t size);
+#endif
+#if RTU_ENABLE_FC10
 /**
  * @brief Write multiple Holding Register.
  * @param id:  modbus device ID. Range: 0x00 ~ 0xF7(0~247), 0x00 is broadcasr address, which all slaves will process broadcast packets, 
@@ -337,11 +479,115 @@ public:
  * @n      11 or eRTU_ID_ERROR: Broadcasr address or error ID
  */
   uint8_t writeHoldingRegister(uint8_t id, uint16_t reg, uint16_t *data, uint16_t regNum);
+#endif
+
+#if RTU_ENABLE_FC08
+/**
+ * @brief Diagnostics(FC08), send a sub-function with a data word, such as reading a counter of the slave.
+ * @param id:  modbus device ID. Range: 0x01 ~ 0xF7(1~247).
+ * @param subFunction: Sub-function code, eRtuDiagnosticsCode_t.
+ * @param data: The data word of the request, 0 when it is NULL. It returns the data word of the answer.
+ * @return Exception code:
+ * @n      0 : sucess.
+ * @n      1 or eRTU_EXCEPTION_ILLEGAL_FUNCTION : Illegal function, the slave does not support FC08 or the sub-function.
+ * @n      2 or eRTU_EXCEPTION_ILLEGAL_DATA_ADDRESS: Illegal data address.
+ * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE:  Illegal data value.
+ * @n      4 or eRTU_EXCEPTION_SLAVE_FAILURE:  Slave failure.
+ * @n      9 or eRTU_RECV_ERROR:  Receive packet error.
+ * @n      10 or eRTU_MEMORY_ERROR: Memory error.
+ * @n      11 or eRTU_ID_ERROR: Broadcasr address or error ID
+ */
+  uint8_t diagnostics(uint8_t id, uint16_t subFunction, uint16_t *data = NULL);
+
+/**
+ * @brief Return query data(FC08 sub-function 0x00), the slave sends the data back unchanged.
+ * @param id:  modbus device ID. Range: 0x01 ~ 0xF7(1~247).
+ * @param data: The data to echo.
+ * @param size: Number of bytes, 1 ~ RTU_MAX_FRAME_SIZE - 6.
+ * @return Exception code, the same as diagnostics.
+ * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE: Also returned when the echo differs from the data.
+ */
+  uint8_t echoDiagnostics(uint8_t id, const uint8_t *data, uint16_t size);
+#endif
+
+#if RTU_ENABLE_FC11
+/**
+ * @brief Report server ID(FC11), the slave answers its type, run status and any device specific data.
+ * @param id:  modbus device ID. Range: 0x01 ~ 0xF7(1~247).
+ * @param data: Storage of the data of the answer.
+ * @param size: Size of data, it returns the number of bytes stored.
+ * @return Exception code, the same as diagnostics.
+ */
+  uint8_t reportServerID(uint8_t id, uint8_t *data, uint8_t *size);
+#endif
+
+#if RTU_ENABLE_FC2B
+/**
+ * @brief Read an object of the device identification(FC2B, MEI type 0x0E, individual access).
+ * @param id:  modbus device ID. Range: 0x01 ~ 0xF7(1~247).
+ * @param objectId: 0x00: VendorName, 0x01: ProductCode, 0x02: MajorMinorRevision, 0x03~0x06: regular objects.
+ * @param value: Storage of the object, it is always terminated by '\0'.
+ * @param size: Size of value.
+ * @return Exception code, the same as diagnostics.
+ * @n      2 or eRTU_EXCEPTION_ILLEGAL_DATA_ADDRESS: Also returned when the answer does not hold the object.
+ */
+  uint8_t readDeviceIdentification(uint8_t id, uint8_t objectId, char *value, uint8_t size);
+#endif
+
+#if RTU_ENABLE_BATCH
+/**
+ * @brief Execute a list of transactions back to back. The requests are built in place without allocation and the
+ * @n     next request is sent as soon as the bus has been silent for t3.5 after the previous answer, set the baudrate
+ * @n     by setBaudrate() first. Every transaction waits for its answer up to the timeout of setTimeoutTimeMs().
+ * @param list: The transactions, read data is stored in their data buffers.
+ * @param num: Number of transactions.
+ * @param result: Status and latency of every transaction, it can be NULL.
+ * @param stopOnError: true: skip the remaining transactions after the first error, their status is eRTU_NOT_EXECUTED.
+ * @n                  false: execute all transactions.
+ * @return Exception code of the first failed transaction, 0: all sucess.
+ * @n      1 or eRTU_EXCEPTION_ILLEGAL_FUNCTION: Also returned when the function code is unknown or disabled.
+ * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE: Also returned when num or data does not fit a frame.
+ * @n      11 or eRTU_ID_ERROR: The ID is above 0xF7, or a read function code is sent to the broadcast address.
+ * @n      12 or eRTU_NOT_EXECUTED: Also returned when the bus was never silent for t3.5 within the timeout, the
+ * @n      request is not sent.
+ */
+  uint8_t executeBatch(sRtuTransaction_t *list, uint16_t num, sRtuResult_t *result = NULL, bool stopOnError = true);
+#endif
+
+/**
+ * @brief modbus CRC16 of a buffer, with the table or bitwise as set by RTU_CRC_TABLE.
+ * @param data: The bytes.
+ * @param len: Number of bytes.
+ * @return The CRC with its bytes swapped, the high byte is the first one sent.
+ */
+  static uint16_t calculateCRC(uint8_t *data, uint16_t len);
+/**
+ * @brief Add one byte to a running modbus CRC16, start with 0xFFFF.
+ * @param crc: The CRC so far.
+ * @param data: The next byte.
+ * @return The new CRC, not swapped.
+ */
+  static uint16_t updateCRC(uint16_t crc, uint8_t data);
+
+protected:
+#if RTU_ENABLE_BATCH
+/**
+ * @brief Build the request frame of a transaction.
+ * @param frame: Buffer of RTU_MAX_FRAME_SIZE bytes.
+ * @param t: The transaction.
+ * @param data: Output, the data argument of checkFrame for the answer.
+ * @param error: Output, exception code when the transaction is invalid.
+ * @return Length of the request, 0: invalid transaction.
+ */
+  uint16_t packRequest(uint8_t *frame, const sRtuTransaction_t *t, uint16_t *data, uint8_t *error);
+#endif
 
-  
-private:
   uint32_t _timeout;
   Stream *_s;
   int _dePin;
+  uint32_t _baud;
+  uint32_t _t35Us;
+  uint32_t _lastUs;   /**<micros() of the last byte sent or received*/
+  sRtuStatistics_t _stat;  /**<Always present, only counted when RTU_ENABLE_STATISTICS is 1*/
 };
 #endif
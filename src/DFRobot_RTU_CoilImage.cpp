@@ -0,0 +1,198 @@
+/*!
+ * @file DFRobot_RTU_CoilImage.cpp
+ * @brief Bit-packed image of a block of coils of a modbus slave.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include <Arduino.h>
+#include "DFRobot_RTU_CoilImage.h"
+
+//Compiled out when a function code it needs is disabled in DFRobot_RTU_Config.h.
+#if RTU_ENABLE_FC01 && RTU_ENABLE_FC05 && RTU_ENABLE_FC0F
+
+DFRobot_RTU_CoilImage::DFRobot_RTU_CoilImage(DFRobot_RTU *rtu, uint8_t id, uint16_t reg, uint16_t coilNum)
+  :DFRobot_RTU_Image(coilNum, 1, RTU_MAX_WRITE_COILS), _rtu(rtu), _id(id), _reg(reg), _coilNum(coilNum), _bytes((coilNum + 7) / 8), _image(NULL), _synced(NULL){}
+
+DFRobot_RTU_CoilImage::~DFRobot_RTU_CoilImage(){
+  if(_image != NULL) free(_image);
+}
+
+uint8_t DFRobot_RTU_CoilImage::begin(){
+  if(_image != NULL) free(_image);
+  if((_bytes == 0) || ((_image = (uint8_t *)malloc(_bytes * 2)) == NULL)){
+    RTU_DBG("Memory ERROR");
+    _image = _synced = NULL;
+    return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  }
+  _synced = _image + _bytes;
+  memset(_image, 0, _bytes * 2);
+  return beginKnown();
+}
+
+uint8_t DFRobot_RTU_CoilImage::read(){
+  uint16_t num = 0;
+  uint8_t ret = 0;
+  if((_rtu == NULL) || (_image == NULL)) return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  //RTU_MAX_READ_COILS is a multiple of 8, every chunk starts on a byte of the image.
+  for(uint16_t i = 0; i < _coilNum; i += num){
+    num = ((_coilNum - i) > RTU_MAX_READ_COILS) ? RTU_MAX_READ_COILS : (_coilNum - i);
+    if((ret = _rtu->readCoilsRegister(_id, _reg + i, num, _synced + (i >> 3), (num + 7) / 8)) != 0) return ret;
+    if(num % 8) _synced[(i + num - 1) >> 3] &= (1 << (num % 8)) - 1;
+    memcpy(_image + (i >> 3), _synced + (i >> 3), (num + 7) / 8);
+    setKnown(i, i + num);
+  }
+  return 0;
+}
+
+uint8_t DFRobot_RTU_CoilImage::flush(){
+  if((_rtu == NULL) || (_image == NULL)) return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  return flushRuns(false);
+}
+
+void DFRobot_RTU_CoilImage::invalidate(){
+  if(_image == NULL) return;
+  for(uint16_t i = 0; i < _bytes; i++){
+    _synced[i] = ~_image[i];
+  }
+}
+
+bool DFRobot_RTU_CoilImage::isDirty(){
+  return (_image != NULL) && (nextDirty(0) < _coilNum);
+}
+
+bool DFRobot_RTU_CoilImage::get(uint16_t coil){
+  return getBits(coil, 1) != 0;
+}
+
+void DFRobot_RTU_CoilImage::set(uint16_t coil, bool flag){
+  setBits(coil, 1, flag ? 1 : 0);
+}
+
+void DFRobot_RTU_CoilImage::toggle(uint16_t coil){
+  toggleBits(coil, 1, 1);
+}
+
+uint32_t DFRobot_RTU_CoilImage::getBits(uint16_t coil, uint8_t num){
+  if((_image == NULL) || (coil < _reg) || (num == 0) || (num > 32) || ((uint32_t)(coil - _reg) + num > _coilNum)) return 0;
+  return extract(_image, coil - _reg, num);
+}
+
+void DFRobot_RTU_CoilImage::setBits(uint16_t coil, uint8_t num, uint32_t value){
+  if((_image == NULL) || (coil < _reg) || (num == 0) || (num > 32) || ((uint32_t)(coil - _reg) + num > _coilNum)) return;
+  deposit(_image, coil - _reg, num, value);
+}
+
+void DFRobot_RTU_CoilImage::toggleBits(uint16_t coil, uint8_t num, uint32_t mask){
+  setBits(coil, num, getBits(coil, num) ^ mask);
+}
+
+void DFRobot_RTU_CoilImage::setRange(uint16_t coil, uint16_t num, bool flag){
+  uint16_t bit = coil - _reg;
+  uint8_t n = 0;
+  if((_image == NULL) || (coil < _reg) || ((uint32_t)bit + num > _coilNum)) return;
+  //Head up to a byte boundary, whole bytes, then the tail.
+  while(num && (bit & 7)){
+    n = ((8 - (bit & 7)) < num) ? (8 - (bit & 7)) : num;
+    deposit(_image, bit, n, flag ? 0xFF : 0);
+    bit += n;
+    num -= n;
+  }
+  if(num >= 8){
+    memset(_image + (bit >> 3), flag ? 0xFF : 0, num >> 3);
+    bit += num & ~7;
+    num &= 7;
+  }
+  if(num) deposit(_image, bit, num, flag ? 0xFF : 0);
+}
+
+uint32_t DFRobot_RTU_CoilImage::extract(uint8_t *buf, uint16_t bit, uint8_t num){
+  uint32_t val = 0;
+  uint8_t got = 0, off = 0, take = 0;
+  while(got < num){
+    off = bit & 7;
+    take = ((8 - off) < (num - got)) ? (8 - off) : (num - got);
+    val |= (uint32_t)((buf[bit >> 3] >> off) & ((1 << take) - 1)) << got;
+    got += take;
+    bit += take;
+  }
+  return val;
+}
+
+void DFRobot_RTU_CoilImage::deposit(uint8_t *buf, uint16_t bit, uint8_t num, uint32_t value){
+  uint8_t put = 0, off = 0, take = 0, mask = 0;
+  while(put < num){
+    off = bit & 7;
+    take = ((8 - off) < (num - put)) ? (8 - off) : (num - put);
+    mask = ((1 << take) - 1) << off;
+    buf[bit >> 3] = (buf[bit >> 3] & ~mask) | (((value >> put) << off) & mask);
+    put += take;
+    bit += take;
+  }
+}
+
+bool DFRobot_RTU_CoilImage::isItemDirty(uint16_t bit){
+  return ((_image[bit >> 3] ^ _synced[bit >> 3]) >> (bit & 7)) & 0x01;
+}
+
+//Whole clean or whole dirty bytes are skipped at once.
+uint16_t DFRobot_RTU_CoilImage::nextDirty(uint16_t bit){
+  while(bit < _coilNum){
+    if(((bit & 7) == 0) && ((_image[bit >> 3] ^ _synced[bit >> 3]) == 0)){
+      bit += 8;
+      continue;
+    }
+    if(isItemDirty(bit)) return bit;
+    bit++;
+  }
+  return _coilNum;
+}
+
+uint16_t DFRobot_RTU_CoilImage::nextClean(uint16_t bit){
+  while(bit < _coilNum){
+    if(((bit & 7) == 0) && ((uint8_t)(_image[bit >> 3] ^ _synced[bit >> 3]) == 0xFF)){
+      bit += 8;
+      continue;
+    }
+    if(!isItemDirty(bit)) return bit;
+    bit++;
+  }
+  return _coilNum;
+}
+
+uint8_t DFRobot_RTU_CoilImage::writeSpan(uint16_t start, uint16_t end, uint16_t dirty, bool /*verify*/){
+  uint16_t num = end - start;
+  uint16_t size = (num + 7) / 8;
+  uint8_t *data = NULL;
+  uint8_t ret = 0;
+  if(singleWrites(num, dirty)){
+    for(uint16_t bit = start; bit < end; bit++){
+      if(!isItemDirty(bit)) continue;
+      if((ret = _rtu->writeCoilsRegister(_id, _reg + bit, (bool)extract(_image, bit, 1))) != 0) return ret;
+      deposit(_synced, bit, 1, extract(_image, bit, 1));
+      setKnown(bit, bit + 1);
+    }
+    return 0;
+  }
+  if((data = (uint8_t *)malloc(size)) == NULL){
+    RTU_DBG("Memory ERROR");
+    return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  }
+  for(uint16_t i = 0; i < size; i++){
+    data[i] = (uint8_t)extract(_image, start + i * 8, ((num - i * 8) < 8) ? (num - i * 8) : 8);
+  }
+  ret = _rtu->writeCoilsRegister(_id, _reg + start, num, data, size);
+  if(ret == 0){
+    for(uint16_t i = 0; i < size; i++){
+      deposit(_synced, start + i * 8, ((num - i * 8) < 8) ? (num - i * 8) : 8, data[i]);
+    }
+    setKnown(start, end);
+  }
+  free(data);
+  return ret;
+}
+#endif
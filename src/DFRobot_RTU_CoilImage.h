@@ -0,0 +1,127 @@
+/*!
+ * @file DFRobot_RTU_CoilImage.h
+ * @brief Bit-packed image of a block of coils of a modbus slave. Coils are changed locally, and flush() only writes
+ * @n     the coils that differ from the slave, merged into the cheapest set of FC05/FC0F transactions.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#ifndef __DFRobot_RTU_COILIMAGE_H
+#define __DFRobot_RTU_COILIMAGE_H
+
+#include "DFRobot_RTU_Image.h"
+
+//Compiled out when a function code it needs is disabled in DFRobot_RTU_Config.h.
+#if RTU_ENABLE_FC01 && RTU_ENABLE_FC05 && RTU_ENABLE_FC0F
+class DFRobot_RTU_CoilImage: public DFRobot_RTU_Image{
+public:
+/**
+ * @brief DFRobot_RTU_CoilImage constructor.
+ * @param rtu:  The modbus master used to read and write the coils.
+ * @param id:  modbus device ID. Range: 0x01 ~ 0xF7(1~247).
+ * @param reg: Start address of the coils block.
+ * @param coilNum: Number of coils of the block.
+ */
+  DFRobot_RTU_CoilImage(DFRobot_RTU *rtu, uint8_t id, uint16_t reg, uint16_t coilNum);
+  ~DFRobot_RTU_CoilImage();
+
+/**
+ * @brief Allocate the image, all coils are 0 and considered in sync with the slave, but their state in the slave is
+ * @n     unknown: flush() does not merge runs across coils that were never read or written, so a merged FC0F never
+ * @n     switches off an output the master has not seen.
+ * @return Exception code:
+ * @n      0 : sucess.
+ * @n      10 or eRTU_MEMORY_ERROR: Memory error.
+ */
+  uint8_t begin();
+
+/**
+ * @brief Read all coils of the block from the slave, local changes are discarded. A block larger than
+ * @n     RTU_MAX_READ_COILS is read with several requests.
+ * @return Exception code, the same as DFRobot_RTU::readCoilsRegister.
+ */
+  uint8_t read();
+
+/**
+ * @brief Write the changed coils to the slave. Changed runs close to each other are merged when writing the coils
+ * @n     between them costs fewer bus bytes than another request and their state is known from read() or an earlier
+ * @n     write, and every run is sent by FC05 or FC0F, whichever
+ * @n     is cheaper. It stops at the first error, the coils not written stay dirty.
+ * @return Exception code, the same as DFRobot_RTU::writeCoilsRegister.
+ */
+  uint8_t flush();
+
+/**
+ * @brief Mark all coils as changed, the next flush() writes the whole block.
+ */
+  void invalidate();
+
+/**
+ * @brief Whether any coil differs from the slave.
+ * @return true: flush() has something to write.
+ */
+  bool isDirty();
+
+/**
+ * @brief Get, set or toggle one coil.
+ * @param coil: Coil address, it must be in the block.
+ */
+  bool get(uint16_t coil);
+  void set(uint16_t coil, bool flag);
+  void toggle(uint16_t coil);
+
+/**
+ * @brief Get up to 32 continuous coils, the first coil is bit 0 of the result.
+ * @param coil: Address of the first coil.
+ * @param num: Number of coils, 1~32.
+ * @return The coils.
+ */
+  uint32_t getBits(uint16_t coil, uint8_t num);
+
+/**
+ * @brief Set up to 32 continuous coils, the first coil is bit 0 of value.
+ * @param coil: Address of the first coil.
+ * @param num: Number of coils, 1~32.
+ * @param value: The coils.
+ */
+  void setBits(uint16_t coil, uint8_t num, uint32_t value);
+
+/**
+ * @brief Toggle the coils selected by mask, bit 0 of mask is the first coil.
+ * @param coil: Address of the first coil.
+ * @param num: Number of coils, 1~32.
+ * @param mask: The coils to toggle.
+ */
+  void toggleBits(uint16_t coil, uint8_t num, uint32_t mask);
+
+/**
+ * @brief Set a range of coils to the same value.
+ * @param coil: Address of the first coil.
+ * @param num: Number of coils.
+ * @param flag: The value of the coils.
+ */
+  void setRange(uint16_t coil, uint16_t num, bool flag);
+
+protected:
+  uint32_t extract(uint8_t *buf, uint16_t bit, uint8_t num);
+  void deposit(uint8_t *buf, uint16_t bit, uint8_t num, uint32_t value);
+  bool isItemDirty(uint16_t bit);
+  uint16_t nextDirty(uint16_t bit);
+  uint16_t nextClean(uint16_t bit);
+  uint8_t writeSpan(uint16_t start, uint16_t end, uint16_t dirty, bool verify);
+
+private:
+  DFRobot_RTU *_rtu;
+  uint8_t _id;
+  uint16_t _reg;
+  uint16_t _coilNum;
+  uint16_t _bytes;
+  uint8_t *_image;   /**<Coils wanted by the user*/
+  uint8_t *_synced;  /**<Coils known to be in the slave, the dirty coils are _image ^ _synced*/
+};
+#endif
+#endif
@@ -0,0 +1,87 @@
+/*!
+ * @file DFRobot_RTU_Config.h
+ * @brief Compile-time configuration of DFRobot_RTU. Every option can be changed here, or by a global build flag
+ * @n     (such as build_flags of PlatformIO, -D of a Makefile) that every source file of the library sees.
+ * @n     A #define in the sketch is not enough: the library sources are compiled separately and would not see it,
+ * @n     the sketch and the library would then disagree on the declared functions and the helper classes.
+ * @n     On small MCUs such as the ATmega328, disable the function codes which are not used and keep
+ * @n     RTU_MAX_FRAME_SIZE small to save flash, RAM and stack.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#ifndef __DFRobot_RTU_CONFIG_H
+#define __DFRobot_RTU_CONFIG_H
+
+//Max size of a request or an answer frame, including the ID and the CRC. modbus RTU allows up to 256 bytes.
+//It bounds the heap and stack buffers of a transaction. On an ATmega328 a build flag of 64 saves RAM and stack and
+//still reads 29 registers or 472 coils at once, larger requests are then refused before they are sent.
+#ifndef RTU_MAX_FRAME_SIZE
+#define RTU_MAX_FRAME_SIZE                         256
+#endif
+
+//Function codes, 1: compiled in, 0: compiled out. The helper classes which need a disabled function code are compiled out too.
+#ifndef RTU_ENABLE_FC01
+#define RTU_ENABLE_FC01                            1    /**<Read coils*/
+#endif
+#ifndef RTU_ENABLE_FC02
+#define RTU_ENABLE_FC02                            1    /**<Read discrete inputs*/
+#endif
+#ifndef RTU_ENABLE_FC03
+#define RTU_ENABLE_FC03                            1    /**<Read holding registers*/
+#endif
+#ifndef RTU_ENABLE_FC04
+#define RTU_ENABLE_FC04                            1    /**<Read input registers*/
+#endif
+#ifndef RTU_ENABLE_FC05
+#define RTU_ENABLE_FC05                            1    /**<Write a coil*/
+#endif
+#ifndef RTU_ENABLE_FC06
+#define RTU_ENABLE_FC06                            1    /**<Write a holding register*/
+#endif
+#ifndef RTU_ENABLE_FC08
+#define RTU_ENABLE_FC08                            1    /**<Diagnostics*/
+#endif
+#ifndef RTU_ENABLE_FC0F
+#define RTU_ENABLE_FC0F                            1    /**<Write multiple coils*/
+#endif
+#ifndef RTU_ENABLE_FC10
+#define RTU_ENABLE_FC10                            1    /**<Write multiple holding registers*/
+#endif
+#ifndef RTU_ENABLE_FC11
+#define RTU_ENABLE_FC11                            1    /**<Report server ID*/
+#endif
+#ifndef RTU_ENABLE_FC2B
+#define RTU_ENABLE_FC2B                            1    /**<Read device identification*/
+#endif
+
+//CRC calculation, 1: 512 bytes table(in flash on AVR), faster, 0: bitwise, smaller.
+#ifndef RTU_CRC_TABLE
+#if defined(__AVR__)
+#define RTU_CRC_TABLE                              0
+#else
+#define RTU_CRC_TABLE                              1
+#endif
+#endif
+
+//1: Count requests, answers, exceptions, timeouts and CRC errors, see getStatistics(). The counters are in the
+//object whatever the option, so the layout of DFRobot_RTU does not depend on the configuration.
+#ifndef RTU_ENABLE_STATISTICS
+#define RTU_ENABLE_STATISTICS                      0
+#endif
+
+//1: Compile executeBatch(), the back to back transaction API.
+#ifndef RTU_ENABLE_BATCH
+#define RTU_ENABLE_BATCH                           1
+#endif
+
+//11 bytes is the smallest frame of an FC10 with one register, below it a multiple write of one item is impossible.
+#if (RTU_MAX_FRAME_SIZE < 11) || (RTU_MAX_FRAME_SIZE > 256)
+#error "RTU_MAX_FRAME_SIZE must be in range 11~256"
+#endif
+
+#endif
@@ -0,0 +1,135 @@
+/*!
+ * @file DFRobot_RTU_Diagnostics.cpp
+ * @brief Commissioning helpers built on FC08 diagnostics.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include <Arduino.h>
+#include "DFRobot_RTU_Diagnostics.h"
+
+//Compiled out when a function code it needs is disabled in DFRobot_RTU_Config.h.
+#if RTU_ENABLE_FC08
+
+//Most likely settings first.
+static const uint32_t _detectBaud[] = {9600, 19200, 115200, 38400, 57600, 4800, 2400, 1200};
+static const uint8_t _detectFormat[] = {
+  DFRobot_RTU_Diagnostics::eRTU_SERIAL_8N1, DFRobot_RTU_Diagnostics::eRTU_SERIAL_8E1,
+  DFRobot_RTU_Diagnostics::eRTU_SERIAL_8N2, DFRobot_RTU_Diagnostics::eRTU_SERIAL_8O1
+};
+static const uint32_t _testBaud[] = {1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200};
+
+DFRobot_RTU_Diagnostics::DFRobot_RTU_Diagnostics(DFRobot_RTU *rtu, rtuSerialConfig_t cb)
+  :_rtu(rtu), _cb(cb){}
+
+uint8_t DFRobot_RTU_Diagnostics::readCounters(uint8_t id, sRtuDiagCounters_t *counters){
+  uint16_t *pCounter = (uint16_t *)counters;
+  uint16_t val = 0;
+  uint8_t ret = 0;
+  if((_rtu == NULL) || (counters == NULL)) return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  //The counters are in the order of their sub-functions.
+  for(uint8_t i = 0; i < (sizeof(sRtuDiagCounters_t) / 2); i++){
+    val = 0;
+    if((ret = _rtu->diagnostics(id, DFRobot_RTU::eDIAG_BUS_MESSAGE_COUNT + i, &val)) != 0) return ret;
+    pCounter[i] = val;
+  }
+  return 0;
+}
+
+uint8_t DFRobot_RTU_Diagnostics::clearCounters(uint8_t id){
+  if(_rtu == NULL) return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  return _rtu->diagnostics(id, DFRobot_RTU::eDIAG_CLEAR_COUNTERS);
+}
+
+uint8_t DFRobot_RTU_Diagnostics::detect(uint8_t id, uint32_t *baud, uint8_t *format){
+  uint8_t probe[2] = {0xA5, 0x5A};
+  uint32_t timeout = 0;
+  uint8_t ret = (uint8_t)DFRobot_RTU::eRTU_RECV_ERROR;
+  if((_rtu == NULL) || (_cb == NULL) || (id == 0) || (id > 0xF7)) return (uint8_t)DFRobot_RTU::eRTU_ID_ERROR;
+  timeout = _rtu->getTimeoutTimeMs();
+  for(uint8_t i = 0; i < sizeof(_detectBaud) / sizeof(_detectBaud[0]); i++){
+    for(uint8_t j = 0; j < sizeof(_detectFormat); j++){
+      configure(_detectBaud[i], _detectFormat[j], true);
+      ret = _rtu->echoDiagnostics(id, probe, sizeof(probe));
+      //Only the right setting gives an answer with a correct CRC, an exception answer counts too.
+      if(ret != (uint8_t)DFRobot_RTU::eRTU_RECV_ERROR){
+        if(baud != NULL) *baud = _detectBaud[i];
+        if(format != NULL) *format = _detectFormat[j];
+        _rtu->setTimeoutTimeMs(timeout);
+        return 0;
+      }
+    }
+  }
+  _rtu->setTimeoutTimeMs(timeout);
+  return (uint8_t)DFRobot_RTU::eRTU_RECV_ERROR;
+}
+
+uint8_t DFRobot_RTU_Diagnostics::lineTest(uint8_t id, uint16_t count, uint8_t size, sRtuLineTest_t *result){
+  uint8_t data[RTU_MAX_FRAME_SIZE - 6];
+  uint16_t seed = 0xACE1;
+  uint32_t start = 0;
+  uint8_t ret = 0;
+  sRtuLineTest_t test;
+  memset(&test, 0, sizeof(test));
+  if((_rtu == NULL) || (size == 0) || (size > sizeof(data))) return (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+  start = micros();
+  for(test.sent = 0; test.sent < count; test.sent++){
+    //Pseudo random data, every request exercises other bit patterns.
+    for(uint8_t i = 0; i < size; i++){
+      seed = (seed >> 1) ^ (-(seed & 1) & 0xB400);
+      data[i] = (uint8_t)seed;
+    }
+    ret = _rtu->echoDiagnostics(id, data, size);
+    if(ret == 0){
+      test.ok++;
+    }else if(ret == (uint8_t)DFRobot_RTU::eRTU_RECV_ERROR){
+      test.lost++;
+    }else{
+      test.corrupted++;
+    }
+  }
+  test.elapsedUs = micros() - start;
+  if(test.elapsedUs != 0) test.bytesPerSecond = (uint32_t)(((uint64_t)test.ok * size * 1000000UL) / test.elapsedUs);
+  if(result != NULL) memcpy(result, &test, sizeof(test));
+  return (test.ok == test.sent) ? 0 : (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+}
+
+uint32_t DFRobot_RTU_Diagnostics::recommendBaud(uint8_t id, uint8_t format, uint16_t count, uint16_t maxErrors){
+  //32 bytes per echo, less when the frame buffer cannot hold them.
+  const uint8_t size = ((RTU_MAX_FRAME_SIZE - 6) < 32) ? (RTU_MAX_FRAME_SIZE - 6) : 32;
+  uint32_t best = 0, timeout = 0;
+  sRtuLineTest_t test;
+  if((_rtu == NULL) || (_cb == NULL) || (count == 0)) return 0;
+  timeout = _rtu->getTimeoutTimeMs();
+  for(uint8_t i = 0; i < sizeof(_testBaud) / sizeof(_testBaud[0]); i++){
+    configure(_testBaud[i], format, true);
+    memset(&test, 0, sizeof(test));
+    //Nothing was sent, the arguments are wrong and no baudrate can be recommended.
+    if((lineTest(id, count, size, &test) != 0) && (test.sent == 0)){
+      best = 0;
+      break;
+    }
+    if((test.lost + test.corrupted) > maxErrors){
+      //Skip failures until a baudrate passes, after that a faster one than a failing one will not do better.
+      if(best != 0) break;
+      continue;
+    }
+    best = _testBaud[i];
+  }
+  if(best != 0) configure(best, format, false);
+  _rtu->setTimeoutTimeMs(timeout);
+  return best;
+}
+
+void DFRobot_RTU_Diagnostics::configure(uint32_t baud, uint8_t format, bool timeout){
+  _cb(baud, format);
+  _rtu->setBaudrate(baud);
+  //The receive timeout restarts at every byte, so it only has to cover the reply time of the slave and one t3.5
+  //(3.5 characters of 11 bits), a wrong setting costs a few ms instead of the default 100ms.
+  if(timeout) _rtu->setTimeoutTimeMs(RTU_DIAG_REPLY_TIME + (38500UL + baud - 1) / baud);
+}
+#endif
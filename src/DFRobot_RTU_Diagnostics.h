@@ -0,0 +1,132 @@
+/*!
+ * @file DFRobot_RTU_Diagnostics.h
+ * @brief Commissioning helpers built on FC08 diagnostics: bus counters of a slave, automatic detection of the
+ * @n     baudrate and format of a slave, and an echo test of the line which recommends the highest reliable baudrate.
+ * @n     The serial port is reconfigured by a callback of the user, because Stream can not change the baudrate.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#ifndef __DFRobot_RTU_DIAGNOSTICS_H
+#define __DFRobot_RTU_DIAGNOSTICS_H
+
+#include "DFRobot_RTU.h"
+
+#ifndef RTU_DIAG_REPLY_TIME
+#define RTU_DIAG_REPLY_TIME                        20   /**<ms allowed to the slave between the request and the answer*/
+#endif
+
+//Compiled out when a function code it needs is disabled in DFRobot_RTU_Config.h.
+#if RTU_ENABLE_FC08
+/**
+ * @brief Serial port configuration callback, it restarts the serial port, such as Serial1.begin(baud, SERIAL_8E1).
+ * @param baud: The baudrate.
+ * @param format: DFRobot_RTU_Diagnostics::eRtuSerialFormat_t.
+ */
+typedef void (*rtuSerialConfig_t)(uint32_t baud, uint8_t format);
+
+class DFRobot_RTU_Diagnostics{
+public:
+typedef enum{
+  eRTU_SERIAL_8N1 = 0,
+  eRTU_SERIAL_8E1,
+  eRTU_SERIAL_8O1,
+  eRTU_SERIAL_8N2
+}eRtuSerialFormat_t;
+
+typedef struct{
+  uint16_t busMessage;        /**<eDIAG_BUS_MESSAGE_COUNT*/
+  uint16_t busCrcError;       /**<eDIAG_BUS_CRC_ERROR_COUNT*/
+  uint16_t busException;      /**<eDIAG_BUS_EXCEPTION_COUNT*/
+  uint16_t slaveMessage;      /**<eDIAG_SLAVE_MESSAGE_COUNT*/
+  uint16_t slaveNoResponse;   /**<eDIAG_SLAVE_NO_RESPONSE_COUNT*/
+  uint16_t slaveNak;          /**<eDIAG_SLAVE_NAK_COUNT*/
+  uint16_t slaveBusy;         /**<eDIAG_SLAVE_BUSY_COUNT*/
+  uint16_t busOverrun;        /**<eDIAG_BUS_OVERRUN_COUNT*/
+}sRtuDiagCounters_t;
+
+typedef struct{
+  uint16_t sent;              /**<Echo requests sent*/
+  uint16_t ok;                /**<Echoes received unchanged*/
+  uint16_t lost;              /**<Requests without a correct answer, CRC errors included*/
+  uint16_t corrupted;         /**<Answers with a correct CRC but different data, or exception answers*/
+  uint32_t elapsedUs;         /**<Duration of the test*/
+  uint32_t bytesPerSecond;    /**<Data bytes echoed unchanged per second*/
+}sRtuLineTest_t;
+
+/**
+ * @brief DFRobot_RTU_Diagnostics constructor.
+ * @param rtu:  The modbus master used to send the diagnostics requests.
+ * @param cb: Serial port configuration callback, it can be NULL if only readCounters() and lineTest() are used.
+ */
+  DFRobot_RTU_Diagnostics(DFRobot_RTU *rtu, rtuSerialConfig_t cb);
+  ~DFRobot_RTU_Diagnostics(){}
+
+/**
+ * @brief Read all bus counters of a slave.
+ * @param id:  modbus device ID. Range: 0x01 ~ 0xF7(1~247).
+ * @param counters: Storage of the counters.
+ * @return Exception code, the same as DFRobot_RTU::diagnostics.
+ */
+  uint8_t readCounters(uint8_t id, sRtuDiagCounters_t *counters);
+
+/**
+ * @brief Clear all bus counters of a slave.
+ * @param id:  modbus device ID. Range: 0x01 ~ 0xF7(1~247).
+ * @return Exception code, the same as DFRobot_RTU::diagnostics.
+ */
+  uint8_t clearCounters(uint8_t id);
+
+/**
+ * @brief Find the baudrate and format of a slave. The common settings are tried first(9600 and 19200, 8N1 and 8E1),
+ * @n     each with one FC08 echo request and a timeout of t3.5 plus RTU_DIAG_REPLY_TIME. Any answer with a
+ * @n     correct CRC, an exception included, means the setting is right. The serial port and the master are left at
+ * @n     the detected setting, or at the last tried one if nothing answers.
+ * @param id:  modbus device ID. Range: 0x01 ~ 0xF7(1~247).
+ * @param baud: Output, the detected baudrate.
+ * @param format: Output, the detected eRtuSerialFormat_t.
+ * @return Exception code:
+ * @n      0 : sucess.
+ * @n      9 or eRTU_RECV_ERROR:  No setting answered.
+ * @n      11 or eRTU_ID_ERROR: Broadcasr address or error ID, or no callback.
+ */
+  uint8_t detect(uint8_t id, uint32_t *baud, uint8_t *format);
+
+/**
+ * @brief Echo test(FC08 sub-function 0x00) of the line at the current setting with varying data.
+ * @param id:  modbus device ID. Range: 0x01 ~ 0xF7(1~247).
+ * @param count: Number of echo requests.
+ * @param size: Data bytes of every request, 1 ~ RTU_MAX_FRAME_SIZE - 6.
+ * @param result: The counts and the throughput.
+ * @return Exception code:
+ * @n      0 : Every echo was unchanged.
+ * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE: Wrong size, or some echoes were lost or corrupted.
+ */
+  uint8_t lineTest(uint8_t id, uint16_t count, uint8_t size, sRtuLineTest_t *result);
+
+/**
+ * @brief Run lineTest() from 1200 up to 115200 baud. Failing baudrates below the first passing one are skipped, the
+ * @n     test stops at the first failing baudrate after it. The device at id must answer at every baudrate: a slave
+ * @n     that follows the baudrate of the master, or a loopback plug, since the FC08 echo answer is the request
+ * @n     itself. The serial port and the master are left at the result, or at 115200 when no baudrate passes.
+ * @param id:  modbus device ID. Range: 0x01 ~ 0xF7(1~247).
+ * @param format: eRtuSerialFormat_t of the line.
+ * @param count: Number of echo requests of 32 bytes(at most RTU_MAX_FRAME_SIZE - 6) at every baudrate.
+ * @param maxErrors: Max lost or corrupted echoes of a reliable baudrate.
+ * @return The last passing baudrate before the first failure after it, 0: no baudrate passes, or count is 0.
+ */
+  uint32_t recommendBaud(uint8_t id, uint8_t format, uint16_t count = 50, uint16_t maxErrors = 0);
+
+protected:
+  void configure(uint32_t baud, uint8_t format, bool timeout);
+
+private:
+  DFRobot_RTU *_rtu;
+  rtuSerialConfig_t _cb;
+};
+#endif
+#endif
@@ -0,0 +1,94 @@
+/*!
+ * @file DFRobot_RTU_Image.cpp
+ * @brief Common part of the local images of a slave block.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include <Arduino.h>
+#include "DFRobot_RTU_Image.h"
+
+//Bus bytes of a transaction: request + response + two t3.5 gaps(about 7 characters).
+//FC05 and FC06 have the same frames, FC0F and FC10 only differ in the size of an item.
+#define RTU_COST_GAP                               7
+#define RTU_COST_SINGLE                            (8 + 8 + RTU_COST_GAP)
+#define RTU_COST_MULTI(n, bits)                    (9 + ((uint32_t)(n) * (bits) + 7) / 8 + 8 + RTU_COST_GAP)
+
+DFRobot_RTU_Image::DFRobot_RTU_Image(uint16_t num, uint8_t itemBits, uint16_t maxWrite)
+  :_num(num), _itemBits(itemBits), _maxWrite(maxWrite), _known(NULL){}
+
+DFRobot_RTU_Image::~DFRobot_RTU_Image(){
+  if(_known != NULL) free(_known);
+}
+
+uint8_t DFRobot_RTU_Image::beginKnown(){
+  if(_known != NULL) free(_known);
+  if((_known = (uint8_t *)malloc((_num + 7) / 8)) == NULL){
+    RTU_DBG("Memory ERROR");
+    return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  }
+  memset(_known, 0, (_num + 7) / 8);
+  return 0;
+}
+
+void DFRobot_RTU_Image::setKnown(uint16_t start, uint16_t end){
+  if(_known == NULL) return;
+  for(uint16_t i = start; (i < end) && (i < _num); i++){
+    _known[i >> 3] |= 1 << (i & 7);
+  }
+}
+
+bool DFRobot_RTU_Image::isKnown(uint16_t start, uint16_t end){
+  if(_known == NULL) return false;
+  for(uint16_t i = start; i < end; i++){
+    if(!((_known[i >> 3] >> (i & 7)) & 0x01)) return false;
+  }
+  return true;
+}
+
+uint8_t DFRobot_RTU_Image::flushRuns(bool verify){
+  uint16_t start = 0, end = 0, next = 0, runEnd = 0, dirty = 0;
+  uint8_t ret = 0;
+  start = nextDirty(0);
+  while(start < _num){
+    end = nextClean(start);
+    if((end - start) > _maxWrite) end = start + _maxWrite;
+    dirty = end - start;
+    //Merge the next run while rewriting the clean items between costs less than a separate request. The items
+    //between are written with the value of the image, which is only the value of the slave when it is known.
+    while((next = nextDirty(end)) < _num){
+      runEnd = nextClean(next);
+      if(((runEnd - start) > _maxWrite) || !isKnown(end, next)) break;
+      if(spanCost(start, runEnd, dirty + runEnd - next) > (spanCost(start, end, dirty) + spanCost(next, runEnd, runEnd - next))) break;
+      dirty += runEnd - next;
+      end = runEnd;
+    }
+    if((ret = writeSpan(start, end, dirty, verify)) != 0) return ret;
+    start = nextDirty(end);
+  }
+  return 0;
+}
+
+bool DFRobot_RTU_Image::singleWrites(uint16_t num, uint16_t dirty){
+  return ((uint32_t)dirty * RTU_COST_SINGLE) < RTU_COST_MULTI(num, _itemBits);
+}
+
+uint16_t DFRobot_RTU_Image::spanCost(uint16_t start, uint16_t end, uint16_t dirty){
+  uint32_t single = (uint32_t)dirty * RTU_COST_SINGLE;
+  uint32_t multi = RTU_COST_MULTI(end - start, _itemBits);
+  return (uint16_t)((single < multi) ? single : multi);
+}
+
+uint16_t DFRobot_RTU_Image::nextDirty(uint16_t index){
+  while((index < _num) && !isItemDirty(index)) index++;
+  return index;
+}
+
+uint16_t DFRobot_RTU_Image::nextClean(uint16_t index){
+  while((index < _num) && isItemDirty(index)) index++;
+  return index;
+}
@@ -0,0 +1,79 @@
+/*!
+ * @file DFRobot_RTU_Image.h
+ * @brief Common part of the local images of a slave block(DFRobot_RTU_CoilImage, DFRobot_RTU_RegisterImage): the
+ * @n     dirty items are merged into runs and every run is written with the cheapest set of single writes
+ * @n     (FC05/FC06) or one multiple write(FC0F/FC10). The cost model only depends on the bits of an item and on the
+ * @n     max number of items of one multiple write. Runs are only merged across items whose value in the slave is
+ * @n     known, read or written before, so a merged write never overwrites a value the master has never seen.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#ifndef __DFRobot_RTU_IMAGE_H
+#define __DFRobot_RTU_IMAGE_H
+
+#include "DFRobot_RTU.h"
+
+class DFRobot_RTU_Image{
+protected:
+/**
+ * @brief DFRobot_RTU_Image constructor.
+ * @param num: Number of items of the block.
+ * @param itemBits: Bits of an item on the bus, 1 for coils, 16 for registers.
+ * @param maxWrite: Max number of items of one multiple write.
+ */
+  DFRobot_RTU_Image(uint16_t num, uint8_t itemBits, uint16_t maxWrite);
+  virtual ~DFRobot_RTU_Image();
+
+/**
+ * @brief Allocate the known map, no item is known.
+ * @return Exception code, 0: sucess, 10 or eRTU_MEMORY_ERROR: Memory error.
+ */
+  uint8_t beginKnown();
+
+/**
+ * @brief Mark items as known, their value in the slave was read or written.
+ * @param start: First item.
+ * @param end: The item after the last one.
+ */
+  void setKnown(uint16_t start, uint16_t end);
+
+/**
+ * @brief Whether the value in the slave of every item of a range is known.
+ * @param start: First item.
+ * @param end: The item after the last one.
+ */
+  bool isKnown(uint16_t start, uint16_t end);
+
+/**
+ * @brief Write all dirty items with the cheapest set of transactions.
+ * @param verify: Passed to writeSpan().
+ * @return Exception code of the first failed writeSpan(), 0: sucess.
+ */
+  uint8_t flushRuns(bool verify);
+
+/**
+ * @brief Whether a run is cheaper to write with single writes than with one multiple write.
+ * @param num: Number of items of the run, from the first to the last dirty one.
+ * @param dirty: Number of dirty items of the run.
+ */
+  bool singleWrites(uint16_t num, uint16_t dirty);
+  uint16_t spanCost(uint16_t start, uint16_t end, uint16_t dirty);
+
+  virtual bool isItemDirty(uint16_t index) = 0;
+  virtual uint16_t nextDirty(uint16_t index);
+  virtual uint16_t nextClean(uint16_t index);
+  virtual uint8_t writeSpan(uint16_t start, uint16_t end, uint16_t dirty, bool verify) = 0;
+
+  uint16_t _num;
+
+private:
+  uint8_t _itemBits;
+  uint16_t _maxWrite;
+  uint8_t *_known;    /**<Bit map of the items whose value in the slave is known*/
+};
+#endif
@@ -0,0 +1,123 @@
+/*!
+ * @file DFRobot_RTU_RegisterImage.cpp
+ * @brief Shadow image of a block of holding registers of a modbus slave.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include <Arduino.h>
+#include "DFRobot_RTU_RegisterImage.h"
+
+//Compiled out when a function code it needs is disabled in DFRobot_RTU_Config.h.
+#if RTU_ENABLE_FC03 && RTU_ENABLE_FC06 && RTU_ENABLE_FC10
+
+DFRobot_RTU_RegisterImage::DFRobot_RTU_RegisterImage(DFRobot_RTU *rtu, uint8_t id, uint16_t reg, uint16_t regNum)
+  :DFRobot_RTU_Image(regNum, 16, RTU_MAX_WRITE_REGISTERS), _rtu(rtu), _id(id), _reg(reg), _regNum(regNum), _image(NULL), _synced(NULL){}
+
+DFRobot_RTU_RegisterImage::~DFRobot_RTU_RegisterImage(){
+  if(_image != NULL) free(_image);
+}
+
+uint8_t DFRobot_RTU_RegisterImage::begin(){
+  if(_image != NULL) free(_image);
+  if((_regNum == 0) || ((_image = (uint16_t *)malloc(_regNum * 4)) == NULL)){
+    RTU_DBG("Memory ERROR");
+    _image = _synced = NULL;
+    return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  }
+  _synced = _image + _regNum;
+  memset(_image, 0, _regNum * 4);
+  return beginKnown();
+}
+
+uint8_t DFRobot_RTU_RegisterImage::read(){
+  uint16_t num = 0;
+  uint8_t ret = 0;
+  if((_rtu == NULL) || (_image == NULL)) return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  for(uint16_t i = 0; i < _regNum; i += num){
+    num = ((_regNum - i) > RTU_MAX_READ_REGISTERS) ? RTU_MAX_READ_REGISTERS : (_regNum - i);
+    if((ret = _rtu->readHoldingRegister(_id, _reg + i, _synced + i, num)) != 0) return ret;
+    memcpy(_image + i, _synced + i, num * 2);
+    setKnown(i, i + num);
+  }
+  return 0;
+}
+
+uint8_t DFRobot_RTU_RegisterImage::flush(bool verify){
+  if((_rtu == NULL) || (_image == NULL)) return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  return flushRuns(verify);
+}
+
+void DFRobot_RTU_RegisterImage::markDirty(uint16_t reg, uint16_t num){
+  if((_image == NULL) || (reg < _reg) || ((uint32_t)(reg - _reg) + num > _regNum)) return;
+  for(uint16_t i = reg - _reg; num; i++, num--){
+    _synced[i] = ~_image[i];
+  }
+}
+
+void DFRobot_RTU_RegisterImage::invalidate(){
+  markDirty(_reg, _regNum);
+}
+
+bool DFRobot_RTU_RegisterImage::isDirty(){
+  return (_image != NULL) && (nextDirty(0) < _regNum);
+}
+
+uint16_t DFRobot_RTU_RegisterImage::get(uint16_t reg){
+  if((_image == NULL) || (reg < _reg) || ((reg - _reg) >= _regNum)) return 0;
+  return _image[reg - _reg];
+}
+
+void DFRobot_RTU_RegisterImage::set(uint16_t reg, uint16_t val){
+  if((_image == NULL) || (reg < _reg) || ((reg - _reg) >= _regNum)) return;
+  _image[reg - _reg] = val;
+}
+
+void DFRobot_RTU_RegisterImage::get(uint16_t reg, uint16_t *data, uint16_t num){
+  if((_image == NULL) || (data == NULL) || (reg < _reg) || ((uint32_t)(reg - _reg) + num > _regNum)) return;
+  memcpy(data, _image + (reg - _reg), num * 2);
+}
+
+void DFRobot_RTU_RegisterImage::set(uint16_t reg, const uint16_t *data, uint16_t num){
+  if((_image == NULL) || (data == NULL) || (reg < _reg) || ((uint32_t)(reg - _reg) + num > _regNum)) return;
+  memcpy(_image + (reg - _reg), data, num * 2);
+}
+
+bool DFRobot_RTU_RegisterImage::isItemDirty(uint16_t index){
+  return _image[index] != _synced[index];
+}
+
+uint8_t DFRobot_RTU_RegisterImage::writeSpan(uint16_t start, uint16_t end, uint16_t dirty, bool verify){
+  uint16_t num = end - start;
+  uint16_t *data = NULL;
+  uint8_t ret = 0;
+  if(singleWrites(num, dirty)){
+    for(uint16_t i = start; i < end; i++){
+      if(!isItemDirty(i)) continue;
+      if((ret = _rtu->writeHoldingRegister(_id, _reg + i, _image[i])) != 0) return ret;
+      _synced[i] = _image[i];
+      setKnown(i, i + 1);
+    }
+  }else{
+    if((ret = _rtu->writeHoldingRegister(_id, _reg + start, _image + start, num)) != 0) return ret;
+    memcpy(_synced + start, _image + start, num * 2);
+    setKnown(start, end);
+  }
+  //The broadcast address has no answer, so there is nothing to read back.
+  if(!verify || (_id == RTU_BROADCAST_ADDRESS)) return 0;
+  if((data = (uint16_t *)malloc(num * 2)) == NULL){
+    RTU_DBG("Memory ERROR");
+    return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  }
+  if((ret = _rtu->readHoldingRegister(_id, _reg + start, data, num)) == 0){
+    memcpy(_synced + start, data, num * 2);
+    if(memcmp(_synced + start, _image + start, num * 2) != 0) ret = (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+  }
+  free(data);
+  return ret;
+}
+#endif
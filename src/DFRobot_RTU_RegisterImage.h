@@ -0,0 +1,106 @@
+/*!
+ * @file DFRobot_RTU_RegisterImage.h
+ * @brief Shadow image of a block of holding registers of a modbus slave. Writes only change the image, flush() merges
+ * @n     the changed registers into the fewest FC06/FC10 transactions and can read them back to verify.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#ifndef __DFRobot_RTU_REGISTERIMAGE_H
+#define __DFRobot_RTU_REGISTERIMAGE_H
+
+#include "DFRobot_RTU_Image.h"
+
+//Compiled out when a function code it needs is disabled in DFRobot_RTU_Config.h.
+#if RTU_ENABLE_FC03 && RTU_ENABLE_FC06 && RTU_ENABLE_FC10
+class DFRobot_RTU_RegisterImage: public DFRobot_RTU_Image{
+public:
+/**
+ * @brief DFRobot_RTU_RegisterImage constructor.
+ * @param rtu:  The modbus master used to read and write the registers.
+ * @param id:  modbus device ID. Range: 0x01 ~ 0xF7(1~247).
+ * @param reg: Start address of the holding registers block.
+ * @param regNum: Number of registers of the block.
+ */
+  DFRobot_RTU_RegisterImage(DFRobot_RTU *rtu, uint8_t id, uint16_t reg, uint16_t regNum);
+  ~DFRobot_RTU_RegisterImage();
+
+/**
+ * @brief Allocate the image, all registers are 0 and considered in sync with the slave, but their value in the slave
+ * @n     is unknown: flush() does not merge runs across registers that were never read or written.
+ * @return Exception code:
+ * @n      0 : sucess.
+ * @n      10 or eRTU_MEMORY_ERROR: Memory error.
+ */
+  uint8_t begin();
+
+/**
+ * @brief Read all registers of the block from the slave, local changes are discarded.
+ * @return Exception code, the same as DFRobot_RTU::readHoldingRegister.
+ */
+  uint8_t read();
+
+/**
+ * @brief Write the changed registers to the slave. Changed runs close to each other are merged when writing the
+ * @n     registers between them costs fewer bus bytes than another request and their value in the slave is known
+ * @n     from read() or an earlier write, every run is sent by FC06 or FC10,
+ * @n     whichever is cheaper. The image is written as it is when flush() is called. It stops at the first error,
+ * @n     the registers not written stay dirty.
+ * @param verify: Read every written run back by FC03, the registers whose value differs stay dirty.
+ * @return Exception code, the same as DFRobot_RTU::writeHoldingRegister.
+ * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE: Also returned when the value read back differs.
+ */
+  uint8_t flush(bool verify = false);
+
+/**
+ * @brief Mark registers as changed even if the value is the same, the next flush() writes them.
+ * @param reg: Address of the first register.
+ * @param num: Number of registers.
+ */
+  void markDirty(uint16_t reg, uint16_t num = 1);
+
+/**
+ * @brief Mark all registers as changed, the next flush() writes the whole block.
+ */
+  void invalidate();
+
+/**
+ * @brief Whether any register differs from the slave.
+ * @return true: flush() has something to write.
+ */
+  bool isDirty();
+
+/**
+ * @brief Get or set a register of the image.
+ * @param reg: Register address, it must be in the block.
+ */
+  uint16_t get(uint16_t reg);
+  void set(uint16_t reg, uint16_t val);
+
+/**
+ * @brief Get or set continuous registers of the image.
+ * @param reg: Address of the first register.
+ * @param data: The values of the registers.
+ * @param num: Number of registers.
+ */
+  void get(uint16_t reg, uint16_t *data, uint16_t num);
+  void set(uint16_t reg, const uint16_t *data, uint16_t num);
+
+protected:
+  bool isItemDirty(uint16_t index);
+  uint8_t writeSpan(uint16_t start, uint16_t end, uint16_t dirty, bool verify);
+
+private:
+  DFRobot_RTU *_rtu;
+  uint8_t _id;
+  uint16_t _reg;
+  uint16_t _regNum;
+  uint16_t *_image;   /**<Registers wanted by the user*/
+  uint16_t *_synced;  /**<Registers known to be in the slave, a register is dirty when it differs from _image*/
+};
+#endif
+#endif
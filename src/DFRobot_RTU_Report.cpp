@@ -0,0 +1,133 @@
+/*!
+ * @file DFRobot_RTU_Report.cpp
+ * @brief Change-driven reporting over a polled block of holding or input registers.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include <Arduino.h>
+#include "DFRobot_RTU_Report.h"
+
+DFRobot_RTU_Report::DFRobot_RTU_Report(DFRobot_RTU *rtu, uint8_t id, DFRobot_RTU::eFunctionCommand_t cmd, uint16_t reg, uint16_t regNum)
+  :_rtu(rtu), _cb(NULL), _id(id), _cmd((uint8_t)cmd), _reg(reg), _regNum(regNum), _valid(false),
+   _image(NULL), _reported(NULL), _band(NULL), _type(NULL){}
+
+DFRobot_RTU_Report::~DFRobot_RTU_Report(){
+  if(_image != NULL) free(_image);
+}
+
+uint8_t DFRobot_RTU_Report::begin(){
+  if(_image != NULL) free(_image);
+  //One allocation for all the arrays, the uint16_t arrays first to keep them aligned.
+  if((_regNum == 0) || ((_image = (uint16_t *)malloc(_regNum * 7)) == NULL)){
+    RTU_DBG("Memory ERROR");
+    _image = NULL;
+    return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  }
+  _reported = _image + _regNum;
+  _band = _reported + _regNum;
+  _type = (uint8_t *)(_band + _regNum);
+  memset(_band, 0, _regNum * 2);
+  memset(_type, 0, _regNum);
+  _valid = false;
+  return 0;
+}
+
+void DFRobot_RTU_Report::setCallback(rtuChangeCallback_t cb){
+  _cb = cb;
+}
+
+void DFRobot_RTU_Report::setDeadband(uint16_t reg, uint8_t type, uint16_t value){
+  if((_image == NULL) || (reg < _reg) || ((reg - _reg) >= _regNum)) return;
+  _type[reg - _reg] = type;
+  _band[reg - _reg] = value;
+}
+
+uint8_t DFRobot_RTU_Report::poll(){
+  uint16_t *data = NULL;
+  uint16_t num = 0;
+  uint8_t ret = 0;
+  if((_rtu == NULL) || (_image == NULL)) return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+#if !RTU_ENABLE_FC03 && !RTU_ENABLE_FC04
+  //No read function code is compiled in, nothing could fill the block.
+  return (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_FUNCTION;
+#endif
+  if((data = (uint16_t *)malloc(_regNum * 2)) == NULL){
+    RTU_DBG("Memory ERROR");
+    return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  }
+  //One request can not hold more than RTU_MAX_READ_REGISTERS, the block is only compared once it is complete.
+  for(uint16_t i = 0; (i < _regNum) && (ret == 0); i += num){
+    num = ((_regNum - i) > RTU_MAX_READ_REGISTERS) ? RTU_MAX_READ_REGISTERS : (_regNum - i);
+    ret = (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_FUNCTION;
+    if(_cmd == DFRobot_RTU::eCMD_READ_INPUT){
+#if RTU_ENABLE_FC04
+      ret = _rtu->readInputRegister(_id, _reg + i, data + i, num);
+#endif
+    }else{
+#if RTU_ENABLE_FC03
+      ret = _rtu->readHoldingRegister(_id, _reg + i, data + i, num);
+#endif
+    }
+  }
+  if(ret == 0) update(data);
+  free(data);
+  return ret;
+}
+
+uint16_t DFRobot_RTU_Report::update(const uint16_t *data){
+  uint16_t num = 0;
+#if !defined(__AVR__)
+  uint32_t a = 0, b = 0;
+#endif
+  if((data == NULL) || (_image == NULL)) return 0;
+  for(uint16_t i = 0; i < _regNum; i++){
+#if !defined(__AVR__)
+    //32 bits targets skip two unchanged registers with one compare, an 8 bits AVR compares word by word faster.
+    if(_valid && ((i + 1) < _regNum) && ((i & 1) == 0)){
+      memcpy(&a, data + i, 4);
+      memcpy(&b, _image + i, 4);
+      if(a == b){
+        i++;
+        continue;
+      }
+    }
+#endif
+    if(_valid && (data[i] == _image[i])) continue;
+    _image[i] = data[i];
+    if(_valid && !exceedDeadband(i, data[i])) continue;
+    if(_cb != NULL) _cb(_id, _reg + i, _valid ? _reported[i] : data[i], data[i]);
+    _reported[i] = data[i];
+    num++;
+  }
+  _valid = true;
+  return num;
+}
+
+uint16_t DFRobot_RTU_Report::getValue(uint16_t reg){
+  if((_image == NULL) || (reg < _reg) || ((reg - _reg) >= _regNum)) return 0;
+  return _reported[reg - _reg];
+}
+
+void DFRobot_RTU_Report::reset(){
+  _valid = false;
+}
+
+bool DFRobot_RTU_Report::exceedDeadband(uint16_t index, uint16_t val){
+  int32_t newVal = val, oldVal = _reported[index];
+  uint32_t diff = 0, base = 0;
+  if(_type[index] & eRTU_DEADBAND_SIGNED){
+    newVal = (int16_t)val;
+    oldVal = (int16_t)_reported[index];
+  }
+  diff = (newVal > oldVal) ? (newVal - oldVal) : (oldVal - newVal);
+  if((_type[index] & 0x7F) == eRTU_DEADBAND_PERCENT){
+    base = (oldVal < 0) ? -oldVal : oldVal;
+    return (diff * 100) > ((uint32_t)_band[index] * base);
+  }
+  return diff > _band[index];
+}
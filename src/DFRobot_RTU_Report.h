@@ -0,0 +1,111 @@
+/*!
+ * @file DFRobot_RTU_Report.h
+ * @brief Change-driven reporting over a polled block of holding or input registers. The previous image of the block
+ * @n     is kept, new results are compared word by word(two words at a time on 32 bits targets) and the callback is
+ * @n     only called for the registers whose change exceeds their absolute or percentage deadband. A block larger
+ * @n     than RTU_MAX_READ_REGISTERS is polled with several requests.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#ifndef __DFRobot_RTU_REPORT_H
+#define __DFRobot_RTU_REPORT_H
+
+#include "DFRobot_RTU.h"
+
+/**
+ * @brief Change callback.
+ * @param id:  modbus device ID.
+ * @param reg: Register address.
+ * @param oldVal: The last reported value of the register.
+ * @param newVal: The new value of the register.
+ */
+typedef void (*rtuChangeCallback_t)(uint8_t id, uint16_t reg, uint16_t oldVal, uint16_t newVal);
+
+class DFRobot_RTU_Report{
+public:
+typedef enum{
+  eRTU_DEADBAND_ABSOLUTE = 0x00, /**<Report when |new - old| > value*/
+  eRTU_DEADBAND_PERCENT = 0x01,  /**<Report when |new - old| > value% of |old|*/
+  eRTU_DEADBAND_SIGNED = 0x80    /**<Or with the type above, the register is an int16_t*/
+}eRtuDeadbandType_t;
+
+/**
+ * @brief DFRobot_RTU_Report constructor.
+ * @param rtu:  The modbus master used to poll the registers.
+ * @param id:  modbus device ID. Range: 0x01 ~ 0xF7(1~247).
+ * @param cmd: eCMD_READ_HOLDING or eCMD_READ_INPUT.
+ * @param reg: Start address of the register block.
+ * @param regNum: Number of registers of the block.
+ */
+  DFRobot_RTU_Report(DFRobot_RTU *rtu, uint8_t id, DFRobot_RTU::eFunctionCommand_t cmd, uint16_t reg, uint16_t regNum);
+  ~DFRobot_RTU_Report();
+
+/**
+ * @brief Allocate the register image, all the registers default to report on any change.
+ * @return Exception code:
+ * @n      0 : sucess.
+ * @n      10 or eRTU_MEMORY_ERROR: Memory error.
+ */
+  uint8_t begin();
+
+/**
+ * @brief Set the function called for every changed register.
+ * @param cb: The callback function.
+ */
+  void setCallback(rtuChangeCallback_t cb);
+
+/**
+ * @brief Set the deadband of a register.
+ * @param reg: Register address, it must be in the block.
+ * @param type: eRTU_DEADBAND_ABSOLUTE or eRTU_DEADBAND_PERCENT, or with eRTU_DEADBAND_SIGNED for int16_t registers.
+ * @param value: Deadband in register units(absolute) or in percent of the last reported value(percent), 0 reports on any change.
+ */
+  void setDeadband(uint16_t reg, uint8_t type, uint16_t value);
+
+/**
+ * @brief Read the block once and report the changed registers. The first successful poll reports all registers.
+ * @return Exception code, the same as DFRobot_RTU::readHoldingRegister, 1 when FC03 and FC04 are both disabled.
+ */
+  uint8_t poll();
+
+/**
+ * @brief Feed a block read by other means(such as a batch of transactions) and report the changed registers.
+ * @param data: The values of the registers of the block, regNum words.
+ * @return Number of reported registers.
+ */
+  uint16_t update(const uint16_t *data);
+
+/**
+ * @brief Get the last reported value of a register.
+ * @param reg: Register address, it must be in the block.
+ * @return The last reported value.
+ */
+  uint16_t getValue(uint16_t reg);
+
+/**
+ * @brief Forget the previous image, the next poll reports all registers again.
+ */
+  void reset();
+
+protected:
+  bool exceedDeadband(uint16_t index, uint16_t val);
+
+private:
+  DFRobot_RTU *_rtu;
+  rtuChangeCallback_t _cb;
+  uint8_t _id;
+  uint8_t _cmd;
+  uint16_t _reg;
+  uint16_t _regNum;
+  bool _valid;
+  uint16_t *_image;     /**<Last read value of each register*/
+  uint16_t *_reported;  /**<Last reported value of each register*/
+  uint16_t *_band;
+  uint8_t *_type;
+};
+#endif
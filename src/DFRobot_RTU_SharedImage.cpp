@@ -0,0 +1,331 @@
+/*!
+ * @file DFRobot_RTU_SharedImage.cpp
+ * @brief Shared memory image of polled register blocks on Linux hosts.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include <Arduino.h>
+#include "DFRobot_RTU_SharedImage.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define RTU_SHM_BLOCKS(seg)                        ((sRtuShmBlock_t *)((seg) + sizeof(sRtuShmHeader_t)))
+
+DFRobot_RTU_SharedImage::DFRobot_RTU_SharedImage(DFRobot_RTU *rtu, const char *name)
+  :_rtu(rtu), _name(name), _fd(-1), _seg(NULL), _size(0), _count(0), _buf(NULL){}
+
+DFRobot_RTU_SharedImage::~DFRobot_RTU_SharedImage(){
+  end();
+}
+
+int16_t DFRobot_RTU_SharedImage::addBlock(uint8_t id, DFRobot_RTU::eFunctionCommand_t cmd, uint16_t reg, uint16_t num){
+  uint16_t max = 0;
+  if((_seg != NULL) || (_count >= RTU_SHM_MAX_BLOCKS) || (id == 0) || (id > 0xF7) || (num == 0)) return -1;
+  //At most what one read request returns.
+  if((cmd == DFRobot_RTU::eCMD_READ_COILS) || (cmd == DFRobot_RTU::eCMD_READ_DISCRETE)){
+    max = RTU_MAX_READ_COILS;
+  }else if((cmd == DFRobot_RTU::eCMD_READ_HOLDING) || (cmd == DFRobot_RTU::eCMD_READ_INPUT)){
+    max = RTU_MAX_READ_REGISTERS;
+  }
+  if(num > max) return -1;
+  memset(&_layout[_count], 0, sizeof(sRtuShmBlock_t));
+  _layout[_count].id = id;
+  _layout[_count].cmd = (uint8_t)cmd;
+  _layout[_count].status = (uint8_t)DFRobot_RTU::eRTU_NOT_EXECUTED;
+  _layout[_count].reg = reg;
+  _layout[_count].num = num;
+  return _count++;
+}
+
+uint8_t DFRobot_RTU_SharedImage::begin(){
+  sRtuShmHeader_t *header = NULL;
+  struct stat st;
+  uint32_t size = sizeof(sRtuShmHeader_t) + _count * sizeof(sRtuShmBlock_t);
+  uint16_t maxSize = 0;
+  void *seg = NULL;
+  if((_count == 0) || (_name == NULL)) return (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+  end();
+  for(uint16_t i = 0; i < _count; i++){
+    _layout[i].offset = size;
+    size += (dataSize(_layout[i].cmd, _layout[i].num) + 7) & ~7;
+    if(dataSize(_layout[i].cmd, _layout[i].num) > maxSize) maxSize = dataSize(_layout[i].cmd, _layout[i].num);
+  }
+  if((_fd = shm_open(_name, O_CREAT | O_RDWR, 0644)) < 0){
+    RTU_DBG("shm_open ERROR");
+    return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  }
+  //The lock is released by the kernel when the publisher exits, a crashed one does not block the next.
+  if(flock(_fd, LOCK_EX | LOCK_NB) != 0){
+    end();
+    return (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+  }
+  //The segment never shrinks, a reader still mapping the previous layout must not fault.
+  if(fstat(_fd, &st) != 0) size = 0;
+  else if((uint32_t)st.st_size > size) size = st.st_size;
+  else if(ftruncate(_fd, size) != 0) size = 0;
+  if((size == 0) || ((_buf = (uint8_t *)malloc(maxSize)) == NULL) ||
+     ((seg = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0)) == MAP_FAILED)){
+    RTU_DBG("Memory ERROR");
+    end();
+    return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  }
+  _seg = (uint8_t *)seg;
+  _size = size;
+  header = (sRtuShmHeader_t *)_seg;
+  //Readers of the previous layout see the new generation in readRetry() before anything else is changed.
+  __atomic_store_n(&header->magic, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&header->generation, header->generation + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  header->version = RTU_SHM_VERSION;
+  header->blockSize = sizeof(sRtuShmBlock_t);
+  header->count = _count;
+  header->reserved = 0;
+  header->size = _size;
+  header->reserved2 = 0;
+  memcpy(RTU_SHM_BLOCKS(_seg), _layout, _count * sizeof(sRtuShmBlock_t));
+  memset(_seg + _layout[0].offset, 0, _size - _layout[0].offset);
+  __atomic_store_n(&header->magic, RTU_SHM_MAGIC, __ATOMIC_RELEASE);
+  return 0;
+}
+
+uint8_t DFRobot_RTU_SharedImage::poll(){
+  uint8_t ret = 0, status = 0;
+  if((_rtu == NULL) || (_seg == NULL)) return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  for(uint16_t i = 0; i < _count; i++){
+    status = (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_FUNCTION;
+    switch(_layout[i].cmd){
+#if RTU_ENABLE_FC01
+      case DFRobot_RTU::eCMD_READ_COILS:
+        status = _rtu->readCoilsRegister(_layout[i].id, _layout[i].reg, _layout[i].num, _buf, dataSize(_layout[i].cmd, _layout[i].num));
+        break;
+#endif
+#if RTU_ENABLE_FC02
+      case DFRobot_RTU::eCMD_READ_DISCRETE:
+        status = _rtu->readDiscreteInputsRegister(_layout[i].id, _layout[i].reg, _layout[i].num, _buf, dataSize(_layout[i].cmd, _layout[i].num));
+        break;
+#endif
+#if RTU_ENABLE_FC03
+      case DFRobot_RTU::eCMD_READ_HOLDING:
+        status = _rtu->readHoldingRegister(_layout[i].id, _layout[i].reg, (uint16_t *)_buf, _layout[i].num);
+        break;
+#endif
+#if RTU_ENABLE_FC04
+      case DFRobot_RTU::eCMD_READ_INPUT:
+        status = _rtu->readInputRegister(_layout[i].id, _layout[i].reg, (uint16_t *)_buf, _layout[i].num);
+        break;
+#endif
+      default:
+        break;
+    }
+    //The bus is read into _buf, the block is odd only during the copy.
+    publish(i, _buf, status);
+    if(status != 0) ret = status;
+  }
+  return ret;
+}
+
+bool DFRobot_RTU_SharedImage::publish(uint16_t index, const void *data, uint8_t status){
+  sRtuShmBlock_t *block = NULL;
+  uint64_t time = 0;
+  uint32_t seq = 0;
+  if((_seg == NULL) || (index >= _count)) return false;
+  block = RTU_SHM_BLOCKS(_seg) + index;
+  if((status == 0) && (data != NULL)) time = nowUs();
+  seq = block->seq;
+  __atomic_store_n(&block->seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  if(time != 0){
+    memcpy(_seg + _layout[index].offset, data, dataSize(_layout[index].cmd, _layout[index].num));
+    __atomic_store_n(&block->timeUs, time, __ATOMIC_RELAXED);
+  }
+  __atomic_store_n(&block->status, status, __ATOMIC_RELAXED);
+  __atomic_store_n(&block->seq, seq + 2, __ATOMIC_RELEASE);
+  return true;
+}
+
+void DFRobot_RTU_SharedImage::end(){
+  if(_seg != NULL){
+    __atomic_store_n(&((sRtuShmHeader_t *)_seg)->magic, 0, __ATOMIC_RELEASE);
+    munmap(_seg, _size);
+    _seg = NULL;
+  }
+  if(_fd >= 0){
+    ::close(_fd);
+    _fd = -1;
+  }
+  if(_buf != NULL){
+    free(_buf);
+    _buf = NULL;
+  }
+  _size = 0;
+}
+
+uint16_t DFRobot_RTU_SharedImage::dataSize(uint8_t cmd, uint16_t num){
+  if((cmd == DFRobot_RTU::eCMD_READ_COILS) || (cmd == DFRobot_RTU::eCMD_READ_DISCRETE)) return (num + 7) / 8;
+  return num * 2;
+}
+
+uint64_t DFRobot_RTU_SharedImage::nowUs(){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+DFRobot_RTU_SharedImageReader::DFRobot_RTU_SharedImageReader(const char *name)
+  :_name(name), _seg(NULL), _layout(NULL), _size(0), _count(0), _generation(0){}
+
+DFRobot_RTU_SharedImageReader::~DFRobot_RTU_SharedImageReader(){
+  close();
+}
+
+bool DFRobot_RTU_SharedImageReader::open(){
+  sRtuShmHeader_t *header = NULL;
+  struct stat st;
+  void *seg = NULL;
+  int fd = -1;
+  bool ret = false;
+  close();
+  if((_name == NULL) || ((fd = shm_open(_name, O_RDONLY, 0)) < 0)) return false;
+  if((fstat(fd, &st) == 0) && ((uint32_t)st.st_size >= sizeof(sRtuShmHeader_t))){
+    seg = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  //The mapping stays valid after close().
+  ::close(fd);
+  if((seg == NULL) || (seg == MAP_FAILED)) return false;
+  _seg = (uint8_t *)seg;
+  _size = st.st_size;
+  header = (sRtuShmHeader_t *)_seg;
+  if(__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == RTU_SHM_MAGIC){
+    _generation = header->generation;
+    _count = header->count;
+    if((header->version == RTU_SHM_VERSION) && (header->blockSize == sizeof(sRtuShmBlock_t)) &&
+       (sizeof(sRtuShmHeader_t) + (uint32_t)_count * sizeof(sRtuShmBlock_t) <= _size) &&
+       ((_layout = (sRtuShmBlock_t *)malloc(_count * sizeof(sRtuShmBlock_t))) != NULL)){
+      //A private copy of the layout, the offsets used by getData() can not change under the reader.
+      memcpy(_layout, RTU_SHM_BLOCKS(_seg), _count * sizeof(sRtuShmBlock_t));
+      ret = true;
+      for(uint16_t i = 0; i < _count; i++){
+        if(_layout[i].offset + (uint32_t)DFRobot_RTU_SharedImage::dataSize(_layout[i].cmd, _layout[i].num) > _size) ret = false;
+      }
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      ret = ret && valid();
+    }
+  }
+  if(!ret) close();
+  return ret;
+}
+
+void DFRobot_RTU_SharedImageReader::close(){
+  if(_seg != NULL){
+    munmap(_seg, _size);
+    _seg = NULL;
+  }
+  if(_layout != NULL){
+    free(_layout);
+    _layout = NULL;
+  }
+  _size = 0;
+  _count = 0;
+}
+
+bool DFRobot_RTU_SharedImageReader::valid(){
+  sRtuShmHeader_t *header = (sRtuShmHeader_t *)_seg;
+  if(header == NULL) return false;
+  return (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == RTU_SHM_MAGIC) &&
+         (__atomic_load_n(&header->generation, __ATOMIC_RELAXED) == _generation);
+}
+
+uint16_t DFRobot_RTU_SharedImageReader::getCount(){
+  return _count;
+}
+
+const sRtuShmBlock_t *DFRobot_RTU_SharedImageReader::getBlock(uint16_t index){
+  if(index >= _count) return NULL;
+  return &_layout[index];
+}
+
+int16_t DFRobot_RTU_SharedImageReader::find(uint8_t id, uint8_t cmd, uint16_t reg, uint16_t num){
+  for(uint16_t i = 0; i < _count; i++){
+    if((_layout[i].id == id) && (_layout[i].cmd == cmd) && (reg >= _layout[i].reg) &&
+       ((uint32_t)reg + num <= (uint32_t)_layout[i].reg + _layout[i].num)) return i;
+  }
+  return -1;
+}
+
+uint32_t DFRobot_RTU_SharedImageReader::readBegin(uint16_t index){
+  if(index >= _count) return 1;
+  return __atomic_load_n(&RTU_SHM_BLOCKS(_seg)[index].seq, __ATOMIC_ACQUIRE);
+}
+
+bool DFRobot_RTU_SharedImageReader::readRetry(uint16_t index, uint32_t seq){
+  sRtuShmHeader_t *header = (sRtuShmHeader_t *)_seg;
+  if(index >= _count) return true;
+  //Orders the reads of the values before the second read of the counter.
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return (seq & 1) || (__atomic_load_n(&RTU_SHM_BLOCKS(_seg)[index].seq, __ATOMIC_RELAXED) != seq) ||
+         (__atomic_load_n(&header->generation, __ATOMIC_RELAXED) != _generation);
+}
+
+const void *DFRobot_RTU_SharedImageReader::getData(uint16_t index){
+  if(index >= _count) return NULL;
+  return _seg + _layout[index].offset;
+}
+
+uint8_t DFRobot_RTU_SharedImageReader::read(uint16_t index, void *data, uint16_t size, uint64_t *timeUs){
+  //A larger buffer is fine, only the values of the block are copied.
+  if((index < _count) && (size < DFRobot_RTU_SharedImage::dataSize(_layout[index].cmd, _layout[index].num))){
+    return (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+  }
+  return copy(index, 0, data, size, timeUs);
+}
+
+uint8_t DFRobot_RTU_SharedImageReader::readRegisters(uint8_t id, uint8_t cmd, uint16_t reg, uint16_t *data, uint16_t regNum){
+  int16_t index = -1;
+  if((cmd != DFRobot_RTU::eCMD_READ_HOLDING) && (cmd != DFRobot_RTU::eCMD_READ_INPUT)) return (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_FUNCTION;
+  if(_seg == NULL) return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  if((index = find(id, cmd, reg, regNum)) < 0) return (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+  return copy(index, (reg - _layout[index].reg) * 2, data, regNum * 2, NULL);
+}
+
+uint8_t DFRobot_RTU_SharedImageReader::copy(uint16_t index, uint16_t offset, void *data, uint16_t size, uint64_t *timeUs){
+  sRtuShmBlock_t *block = NULL;
+  uint64_t time = 0;
+  uint32_t seq = 0;
+  uint16_t len = 0;
+  uint8_t status = 0;
+  if(_seg == NULL) return (uint8_t)DFRobot_RTU::eRTU_MEMORY_ERROR;
+  if(index >= _count) return (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+  len = DFRobot_RTU_SharedImage::dataSize(_layout[index].cmd, _layout[index].num);
+  if((data == NULL) || (offset >= len)) return (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+  //Never past the end of the block, whatever the size of data.
+  len -= offset;
+  if(size < len) len = size;
+  block = RTU_SHM_BLOCKS(_seg) + index;
+  for(uint16_t i = 0; i < RTU_SHM_READ_RETRY; i++){
+    seq = readBegin(index);
+    memcpy(data, _seg + _layout[index].offset + offset, len);
+    status = __atomic_load_n(&block->status, __ATOMIC_RELAXED);
+    time = __atomic_load_n(&block->timeUs, __ATOMIC_RELAXED);
+    if(!readRetry(index, seq)){
+      if(timeUs != NULL) *timeUs = time;
+      return status;
+    }
+    if(!valid()) break;
+    //The publisher may be preempted in the middle of a write, give it the CPU.
+    if(seq & 1) sched_yield();
+  }
+  return (uint8_t)DFRobot_RTU::eRTU_RECV_ERROR;
+}
+#endif
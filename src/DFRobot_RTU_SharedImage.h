@@ -0,0 +1,232 @@
+/*!
+ * @file DFRobot_RTU_SharedImage.h
+ * @brief Shared memory image of polled register blocks on Linux hosts. One publisher process polls the bus and
+ * @n     writes every block into a POSIX shared memory segment, any number of local reader processes map the segment
+ * @n     and read the latest values without touching the bus. Every block has a sequence counter(seqlock): the
+ * @n     publisher makes it odd before writing and even after, a reader retries when it changed during the read, so
+ * @n     readers never take a lock and never block the publisher.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#ifndef __DFRobot_RTU_SHARED_IMAGE_H
+#define __DFRobot_RTU_SHARED_IMAGE_H
+
+#include "DFRobot_RTU.h"
+
+#if defined(__linux__)
+
+#ifndef RTU_SHM_MAX_BLOCKS
+#define RTU_SHM_MAX_BLOCKS                         64   /**<Max number of blocks of a publisher*/
+#endif
+
+#ifndef RTU_SHM_READ_RETRY
+#define RTU_SHM_READ_RETRY                         1000 /**<Attempts of read() before it gives up on a block being written*/
+#endif
+
+#define RTU_SHM_MAGIC                              0x53555452 /**<"RTUS"*/
+#define RTU_SHM_VERSION                            1    /**<Change it when the layout of the segment changes*/
+
+/**
+ * @brief Layout of the segment: sRtuShmHeader_t, count sRtuShmBlock_t, then the values of every block at its
+ * @n     offset, 8 bytes aligned. Registers are uint16_t in host byte order, coils and discrete inputs are packed
+ * @n     8 per byte as in the answer, LSB first.
+ */
+typedef struct{
+  uint32_t magic;                                 /**<RTU_SHM_MAGIC when the layout is complete, 0 while it is built*/
+  uint32_t generation;                            /**<Incremented at every begin() of the publisher*/
+  uint16_t version;
+  uint16_t blockSize;                             /**<sizeof(sRtuShmBlock_t)*/
+  uint16_t count;
+  uint16_t reserved;
+  uint32_t size;                                  /**<Bytes of the segment*/
+  uint32_t reserved2;
+}sRtuShmHeader_t;
+
+typedef struct{
+  uint32_t seq;                                   /**<Even: stable, odd: being written*/
+  uint8_t id;
+  uint8_t cmd;                                    /**<eCMD_READ_COILS ~ eCMD_READ_INPUT*/
+  uint8_t status;                                 /**<Exception code of the last poll, the values are kept on error*/
+  uint8_t reserved;
+  uint16_t reg;
+  uint16_t num;
+  uint32_t offset;                                /**<Offset of the values from the start of the segment*/
+  uint64_t timeUs;                                /**<CLOCK_MONOTONIC time of the last successful poll, 0: never*/
+}sRtuShmBlock_t;
+
+class DFRobot_RTU_SharedImage{
+public:
+/**
+ * @brief DFRobot_RTU_SharedImage constructor, the publisher side.
+ * @param rtu:  The modbus master of the bus.
+ * @param name: Name of the shared memory segment, such as "/dfrobot_rtu", it is /dev/shm/dfrobot_rtu.
+ */
+  DFRobot_RTU_SharedImage(DFRobot_RTU *rtu, const char *name = "/dfrobot_rtu");
+  ~DFRobot_RTU_SharedImage();
+
+/**
+ * @brief Add a block to the image, before begin().
+ * @param id:  modbus device ID. Range: 0x01 ~ 0xF7(1~247).
+ * @param cmd: eCMD_READ_COILS, eCMD_READ_DISCRETE, eCMD_READ_HOLDING or eCMD_READ_INPUT.
+ * @param reg: Start address.
+ * @param num: Number of registers or bits, at most one read request.
+ * @return Index of the block, -1: Wrong parameter, too many blocks or already begun.
+ */
+  int16_t addBlock(uint8_t id, DFRobot_RTU::eFunctionCommand_t cmd, uint16_t reg, uint16_t num);
+
+/**
+ * @brief Create the segment and publish the layout. The segment is locked(flock) while the publisher runs, a
+ * @n     second publisher of the same name is refused. Readers of a previous layout see a new generation.
+ * @n     A child forked after begin() shares the lock, fork the readers before or exec them.
+ * @return Exception code:
+ * @n      0 : sucess.
+ * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE: No block, or another publisher owns the segment.
+ * @n      10 or eRTU_MEMORY_ERROR: The segment can not be created or mapped.
+ */
+  uint8_t begin();
+
+/**
+ * @brief Read every block from the bus and publish it. The bus is read into a private buffer, a block is odd only
+ * @n     while it is copied to the segment.
+ * @return 0: All blocks were read, others: Exception code of the last failed block.
+ */
+  uint8_t poll();
+
+/**
+ * @brief Publish the values of a block read by the caller.
+ * @param index: Index of the block.
+ * @param data: The values in the layout of the segment, NULL to only publish an error status.
+ * @param status: Exception code of the read, the values are not changed if it is not 0.
+ * @return true: sucess, false: Not begun or index out of range.
+ */
+  bool publish(uint16_t index, const void *data, uint8_t status = 0);
+
+/**
+ * @brief Mark the segment invalid for the readers, unmap it and release the lock. The segment itself is kept,
+ * @n     remove it with shm_unlink() or rm /dev/shm/<name>.
+ */
+  void end();
+
+/**
+ * @brief Bytes of the values of a block.
+ */
+  static uint16_t dataSize(uint8_t cmd, uint16_t num);
+
+/**
+ * @brief CLOCK_MONOTONIC time, the clock of sRtuShmBlock_t::timeUs.
+ */
+  static uint64_t nowUs();
+
+private:
+  DFRobot_RTU *_rtu;
+  const char *_name;
+  int _fd;
+  uint8_t *_seg;
+  uint32_t _size;
+  uint16_t _count;
+  uint8_t *_buf;
+  sRtuShmBlock_t _layout[RTU_SHM_MAX_BLOCKS];
+};
+
+class DFRobot_RTU_SharedImageReader{
+public:
+/**
+ * @brief DFRobot_RTU_SharedImageReader constructor, the consumer side.
+ * @param name: Name of the shared memory segment of the publisher.
+ */
+  DFRobot_RTU_SharedImageReader(const char *name = "/dfrobot_rtu");
+  ~DFRobot_RTU_SharedImageReader();
+
+/**
+ * @brief Map the segment read only.
+ * @return true: sucess, false: No segment, or its layout is being built, try again later.
+ */
+  bool open();
+  void close();
+
+/**
+ * @brief Check whether the mapped layout is still the one of the publisher.
+ * @return false: Not open, the publisher ended or restarted, call open() again.
+ */
+  bool valid();
+
+/**
+ * @brief Get the blocks of the image. The layout fields are constant while valid(), seq, status and timeUs are
+ * @n     read through read() or readBegin().
+ * @param index: 0 ~ getCount() - 1.
+ * @return The block, NULL: index out of range.
+ */
+  uint16_t getCount();
+  const sRtuShmBlock_t *getBlock(uint16_t index);
+
+/**
+ * @brief Find the block that holds a range.
+ * @param id:  modbus device ID.
+ * @param cmd: The read function code of the block.
+ * @param reg: Start address of the range.
+ * @param num: Number of registers or bits of the range.
+ * @return Index of the block, -1: No block holds the whole range.
+ */
+  int16_t find(uint8_t id, uint8_t cmd, uint16_t reg, uint16_t num = 1);
+
+/**
+ * @brief Copy free access: read the values in place from getData() between readBegin() and readRetry(), and use
+ * @n     them only when readRetry() returns false.
+ * @n     do{
+ * @n       seq = reader.readBegin(i);
+ * @n       value = ((const uint16_t *)reader.getData(i))[3];
+ * @n     }while(reader.readRetry(i, seq) && reader.valid());
+ * @n     The loop ends with valid() false when the publisher restarted, value is not usable then, call open().
+ * @param index: Index of the block.
+ * @param seq: The value returned by readBegin().
+ * @return readRetry: true: The block was written during the access, or the layout changed, read again.
+ */
+  uint32_t readBegin(uint16_t index);
+  bool readRetry(uint16_t index, uint32_t seq);
+  const void *getData(uint16_t index);
+
+/**
+ * @brief Copy a consistent snapshot of a block.
+ * @param index: Index of the block.
+ * @param data: Storage of the values, at least DFRobot_RTU_SharedImage::dataSize() bytes.
+ * @param size: Size of data, only the values of the block are copied when it is larger.
+ * @param timeUs: Output, time of the last successful poll, NULL if not needed.
+ * @return Exception code:
+ * @n      0 : sucess.
+ * @n      1 ~ 11 : Exception code of the last poll of the publisher, data holds the last good values.
+ * @n      2 or eRTU_EXCEPTION_ILLEGAL_DATA_ADDRESS: index out of range.
+ * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE: size too small.
+ * @n      9 or eRTU_RECV_ERROR: The block stayed busy for RTU_SHM_READ_RETRY attempts, or the layout changed.
+ * @n      10 or eRTU_MEMORY_ERROR: Not open.
+ */
+  uint8_t read(uint16_t index, void *data, uint16_t size, uint64_t *timeUs = NULL);
+
+/**
+ * @brief Copy a consistent snapshot of holding or input registers by address.
+ * @param id:  modbus device ID.
+ * @param cmd: eCMD_READ_HOLDING or eCMD_READ_INPUT.
+ * @param reg: Start address.
+ * @param data: Storage of the values.
+ * @param regNum: Number of registers.
+ * @return Exception code, the same as read(), 2 or eRTU_EXCEPTION_ILLEGAL_DATA_ADDRESS also when no block holds them.
+ */
+  uint8_t readRegisters(uint8_t id, uint8_t cmd, uint16_t reg, uint16_t *data, uint16_t regNum);
+
+protected:
+  uint8_t copy(uint16_t index, uint16_t offset, void *data, uint16_t size, uint64_t *timeUs);
+
+private:
+  const char *_name;
+  uint8_t *_seg;
+  sRtuShmBlock_t *_layout;
+  uint32_t _size;
+  uint16_t _count;
+  uint32_t _generation;
+};
+#endif
+#endif
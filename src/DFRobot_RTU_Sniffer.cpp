@@ -0,0 +1,175 @@
+/*!
+ * @file DFRobot_RTU_Sniffer.cpp
+ * @brief Passive (listen-only) modbus RTU bus sniffer.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include <Arduino.h>
+#include "DFRobot_RTU_Sniffer.h"
+
+#if (RTU_SNIFFER_FRAME_NUM < 2) || (RTU_SNIFFER_FRAME_NUM > 255)
+#error "RTU_SNIFFER_FRAME_NUM must be in range 2~255"
+#endif
+#if (RTU_SNIFFER_FRAME_SIZE < 8) || (RTU_SNIFFER_FRAME_SIZE > 256)
+#error "RTU_SNIFFER_FRAME_SIZE must be in range 8~256"
+#endif
+
+static void writeLE(Print *out, uint32_t val, uint8_t bytes){
+  for(uint8_t i = 0; i < bytes; i++){
+    out->write((uint8_t)((val >> (8*i)) & 0xFF));
+  }
+}
+
+DFRobot_RTU_Sniffer::DFRobot_RTU_Sniffer(Stream *s, int dePin)
+  :DFRobot_RTU(s, dePin), _head(0), _tail(0), _count(0), _receiving(false), _dropped(0){
+  if(_dePin>0){
+    digitalWrite(_dePin,LOW);
+  }
+}
+
+DFRobot_RTU_Sniffer::DFRobot_RTU_Sniffer(Stream *s)
+  :DFRobot_RTU(s), _head(0), _tail(0), _count(0), _receiving(false), _dropped(0){}
+
+void DFRobot_RTU_Sniffer::poll(){
+  sRtuCaptureFrame_t *frame = &_frames[_head];
+  uint32_t now = 0;
+  uint8_t c = 0;
+  while(_s->available()){
+    c = (uint8_t)_s->read();
+    now = micros();
+    if(_receiving && ((now - _lastUs) > _t35Us)){
+      commitFrame(true);
+    }
+    if(!_receiving){
+      frame = nextFrame();
+      frame->timestamp = now;
+      _receiving = true;
+    }
+    if(frame->len >= RTU_SNIFFER_FRAME_SIZE){
+      //Back-to-back frames fill the slot without a gap, export the complete ones before the next byte.
+      commitFrame(false);
+      frame = &_frames[_head];
+    }
+    frame->data[frame->len++] = c;
+    _lastUs = now;
+  }
+  if(_receiving && ((micros() - _lastUs) > _t35Us)){
+    commitFrame(true);
+  }
+}
+
+uint8_t DFRobot_RTU_Sniffer::available(){
+  return _count;
+}
+
+bool DFRobot_RTU_Sniffer::readFrame(sRtuCaptureFrame_t *frame){
+  if(_count == 0) return false;
+  if(frame != NULL){
+    frame->timestamp = _frames[_tail].timestamp;
+    frame->len = _frames[_tail].len;
+    frame->flags = _frames[_tail].flags;
+    memcpy(frame->data, _frames[_tail].data, frame->len);
+  }
+  _tail = (_tail + 1) % RTU_SNIFFER_FRAME_NUM;
+  _count--;
+  return true;
+}
+
+uint32_t DFRobot_RTU_Sniffer::getDroppedFrames(){
+  return _dropped;
+}
+
+void DFRobot_RTU_Sniffer::writeCaptureHeader(Print *out){
+  if(out == NULL) return;
+  out->write((const uint8_t *)"RTUC", 4);
+  out->write((uint8_t)RTU_CAPTURE_VERSION);
+  out->write((uint8_t)0);
+  writeLE(out, _t35Us, 2);
+  writeLE(out, _baud, 4);
+}
+
+void DFRobot_RTU_Sniffer::writeCaptureFrame(Print *out, sRtuCaptureFrame_t *frame){
+  if((out == NULL) || (frame == NULL)) return;
+  writeLE(out, frame->timestamp, 4);
+  writeLE(out, frame->len, 2);
+  out->write(frame->flags);
+  out->write(frame->data, frame->len);
+}
+
+uint8_t DFRobot_RTU_Sniffer::exportCapture(Print *out){
+  uint8_t num = 0;
+  if(out == NULL) return 0;
+  while(_count){
+    writeCaptureFrame(out, &_frames[_tail]);
+    readFrame(NULL);
+    num++;
+  }
+  return num;
+}
+
+DFRobot_RTU_Sniffer::sRtuCaptureFrame_t *DFRobot_RTU_Sniffer::nextFrame(){
+  sRtuCaptureFrame_t *frame = NULL;
+  if(_count == RTU_SNIFFER_FRAME_NUM){
+    _tail = (_tail + 1) % RTU_SNIFFER_FRAME_NUM;
+    _count--;
+    _dropped++;
+  }
+  frame = &_frames[_head];
+  frame->len = 0;
+  frame->flags = 0;
+  return frame;
+}
+
+void DFRobot_RTU_Sniffer::commitFrame(bool gap){
+  sRtuCaptureFrame_t *frame = &_frames[_head];
+  sRtuCaptureFrame_t *next = NULL;
+  uint16_t end = 0;
+  uint16_t crc = 0;
+  while(frame->len){
+    end = 0;
+    if(frame->len >= 4){
+      crc = (frame->data[frame->len - 2] << 8) | frame->data[frame->len - 1];
+      end = (gap && (crc == calculateCRC(frame->data, frame->len - 2))) ? frame->len : findFrameEnd(frame->data, frame->len);
+    }
+    if(end){
+      frame->flags |= eRTU_CAPTURE_CRC_OK;
+    }else if(gap){
+      end = frame->len;
+    }else if(frame->len < RTU_SNIFFER_FRAME_SIZE){
+      //The rest of the slot is the beginning of a frame still being received.
+      return;
+    }else{
+      //No frame ends in a whole slot, the bytes are kept and the burst goes on in the next record.
+      frame->flags |= eRTU_CAPTURE_TRUNCATED;
+      end = frame->len;
+    }
+    _head = (_head + 1) % RTU_SNIFFER_FRAME_NUM;
+    _count++;
+    if(gap && (end >= frame->len)) break;
+    //Two frames were read without a t3.5 gap between them, move the tail into a new slot and check it again.
+    next = nextFrame();
+    next->len = frame->len - end;
+    next->flags = eRTU_CAPTURE_SPLIT;
+    next->timestamp = frame->timestamp + end * (11000000UL / _baud);
+    memcpy(next->data, frame->data + end, next->len);
+    frame->len = end;
+    frame = next;
+  }
+  if(gap) _receiving = false;
+}
+
+uint16_t DFRobot_RTU_Sniffer::findFrameEnd(uint8_t *data, uint16_t len){
+  uint16_t crc = 0xFFFF;
+  for(uint16_t i = 0; i + 3 < len; i++){
+    crc = updateCRC(crc, data[i]);
+    if((i >= 1) && (data[i+1] == (crc & 0xFF)) && (data[i+2] == ((crc >> 8) & 0xFF))){
+      return i + 3;
+    }
+  }
+  return 0;
+}
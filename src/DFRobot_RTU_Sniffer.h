@@ -0,0 +1,126 @@
+/*!
+ * @file DFRobot_RTU_Sniffer.h
+ * @brief Passive (listen-only) modbus RTU bus sniffer. Splits the received byte stream into frames by the
+ * @n     t3.5 silent interval, stores them in a fixed-size ring buffer with microsecond timestamps and exports
+ * @n     them in a compact binary capture format.
+ * @n
+ * @n Capture format (all multi-byte fields are little endian):
+ * @n   file header, 12 bytes: "RTUC"(4) | version(1) = 1 | reserved(1) | t3.5 in us(2) | baudrate(4)
+ * @n   frame record:          timestamp in us(4) | len(2) | flags(1) | data(len), data includes the CRC bytes.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#ifndef __DFRobot_RTU_SNIFFER_H
+#define __DFRobot_RTU_SNIFFER_H
+
+#include "DFRobot_RTU.h"
+
+#ifndef RTU_SNIFFER_FRAME_NUM
+#if defined(__AVR__)
+#define RTU_SNIFFER_FRAME_NUM                      2   /**<Number of frames in the capture ring buffer*/
+#else
+#define RTU_SNIFFER_FRAME_NUM                      16  /**<Number of frames in the capture ring buffer*/
+#endif
+#endif
+
+#ifndef RTU_SNIFFER_FRAME_SIZE
+#define RTU_SNIFFER_FRAME_SIZE                     256 /**<modbus RTU ADU max size is 256 bytes*/
+#endif
+
+#define RTU_CAPTURE_VERSION                        0x01
+
+class DFRobot_RTU_Sniffer: protected DFRobot_RTU{
+public:
+typedef enum{
+  eRTU_CAPTURE_CRC_OK = 0x01,    /**<The CRC of the frame is correct*/
+  eRTU_CAPTURE_TRUNCATED = 0x02, /**<No frame ends in RTU_SNIFFER_FRAME_SIZE bytes, the bytes go on in the next record*/
+  eRTU_CAPTURE_SPLIT = 0x04      /**<No t3.5 gap was seen, the frame was split from the previous one by CRC*/
+}eRtuCaptureFlag_t;
+
+typedef struct{
+  uint32_t timestamp;  /**<micros() when the first byte of the frame was read*/
+  uint16_t len;
+  uint8_t flags;
+  uint8_t data[RTU_SNIFFER_FRAME_SIZE];
+}sRtuCaptureFrame_t;
+
+/**
+ * @brief DFRobot_RTU_Sniffer constructor.
+ * @param s:  The serial port connected to the bus, it must already be opened with the bus baudrate and format.
+ * @param dePin: RS485 flow control, it is held low so that the transceiver never drives the bus.
+ */
+  DFRobot_RTU_Sniffer(Stream *s, int dePin);
+  DFRobot_RTU_Sniffer(Stream *s);
+  ~DFRobot_RTU_Sniffer(){}
+
+/**
+ * @brief Set the bus baudrate, which is used to calculate the t3.5 frame gap, default 9600.
+ */
+  using DFRobot_RTU::setBaudrate;
+
+/**
+ * @brief Read all pending bytes from the serial port and split them into frames. It must be called as often as
+ * @n     possible, at least once every t3.5 (1.75ms above 19200 baud), otherwise the gap between two frames can not be
+ * @n     seen and they are split by CRC instead. The gap is measured when the bytes are read, a UART that hands
+ * @n     them over in FIFO chunks must be set to pass every byte at once, see the busSniffer example for ESP32.
+ */
+  void poll();
+
+/**
+ * @brief Get the number of complete frames in the ring buffer.
+ * @return Number of frames.
+ */
+  uint8_t available();
+
+/**
+ * @brief Pop the oldest frame from the ring buffer.
+ * @param frame: Storage of the frame.
+ * @return true: A frame was read, false: The ring buffer is empty.
+ */
+  bool readFrame(sRtuCaptureFrame_t *frame);
+
+/**
+ * @brief Get the number of records overwritten because the ring buffer was full, the only way bytes are lost.
+ * @return Number of lost records.
+ */
+  uint32_t getDroppedFrames();
+
+/**
+ * @brief Write the capture file header.
+ * @param out: The output, such as Serial or a File.
+ */
+  void writeCaptureHeader(Print *out);
+
+/**
+ * @brief Write a frame record in capture format.
+ * @param out: The output, such as Serial or a File.
+ * @param frame: The frame to write.
+ */
+  void writeCaptureFrame(Print *out, sRtuCaptureFrame_t *frame);
+
+/**
+ * @brief Pop all frames of the ring buffer and write them in capture format. The header must be written once before.
+ * @param out: The output, such as Serial or a File.
+ * @return Number of frames written.
+ */
+  uint8_t exportCapture(Print *out);
+
+protected:
+  void commitFrame(bool gap);
+  sRtuCaptureFrame_t *nextFrame();
+  uint16_t findFrameEnd(uint8_t *data, uint16_t len);
+
+private:
+  sRtuCaptureFrame_t _frames[RTU_SNIFFER_FRAME_NUM];
+  uint8_t _head;
+  uint8_t _tail;
+  uint8_t _count;
+  bool _receiving;
+  uint32_t _dropped;
+};
+#endif
@@ -0,0 +1,144 @@
+/*!
+ * @file DFRobot_RTU_Storage.cpp
+ * @brief Non-volatile storage backends of a binary blob.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include <Arduino.h>
+#include "DFRobot_RTU_Storage.h"
+
+#if defined(__AVR__) || defined(ESP8266) || defined(ESP32)
+#include <EEPROM.h>
+
+DFRobot_RTU_EEPROMStorage::DFRobot_RTU_EEPROMStorage(uint16_t address, uint16_t size)
+  :_address(address), _size(size){}
+
+uint16_t DFRobot_RTU_EEPROMStorage::read(uint8_t *data, uint16_t size){
+  if(data == NULL) return 0;
+  if(size > _size) size = _size;
+#if defined(ESP32)
+  //The EEPROM of ESP is emulated in flash, it has to be mapped to RAM first.
+  if(!EEPROM.begin(_address + _size)) return 0;
+#elif defined(ESP8266)
+  //EEPROM.begin() of ESP8266 returns nothing.
+  EEPROM.begin(_address + _size);
+#endif
+  for(uint16_t i = 0; i < size; i++){
+    data[i] = EEPROM.read(_address + i);
+  }
+  return size;
+}
+
+bool DFRobot_RTU_EEPROMStorage::write(const uint8_t *data, uint16_t size){
+  if((data == NULL) || (size > _size)) return false;
+#if defined(ESP8266) || defined(ESP32)
+#if defined(ESP32)
+  if(!EEPROM.begin(_address + _size)) return false;
+#else
+  EEPROM.begin(_address + _size);
+#endif
+  for(uint16_t i = 0; i < size; i++){
+    EEPROM.write(_address + i, data[i]);
+  }
+  return EEPROM.commit();
+#else
+  for(uint16_t i = 0; i < size; i++){
+    EEPROM.update(_address + i, data[i]);
+  }
+  return true;
+#endif
+}
+#endif
+
+#if defined(ESP32)
+#include <Preferences.h>
+
+DFRobot_RTU_NVSStorage::DFRobot_RTU_NVSStorage(const char *ns, const char *key)
+  :_ns(ns), _key(key){}
+
+uint16_t DFRobot_RTU_NVSStorage::read(uint8_t *data, uint16_t size){
+  Preferences prefs;
+  uint16_t len = 0;
+  if((data == NULL) || !prefs.begin(_ns, true)) return 0;
+  len = prefs.getBytes(_key, data, size);
+  prefs.end();
+  return len;
+}
+
+bool DFRobot_RTU_NVSStorage::write(const uint8_t *data, uint16_t size){
+  Preferences prefs;
+  bool ret = false;
+  if((data == NULL) || !prefs.begin(_ns, false)) return false;
+  ret = (prefs.putBytes(_key, data, size) == size);
+  prefs.end();
+  return ret;
+}
+#endif
+
+#if defined(ESP32) || defined(__linux__)
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+DFRobot_RTU_FileStorage::DFRobot_RTU_FileStorage(const char *path)
+  :_path(path){}
+
+uint16_t DFRobot_RTU_FileStorage::read(uint8_t *data, uint16_t size){
+  FILE *fp = NULL;
+  uint16_t len = 0;
+  if((data == NULL) || (_path == NULL) || ((fp = fopen(_path, "rb")) == NULL)) return 0;
+  len = fread(data, 1, size, fp);
+  fclose(fp);
+  return len;
+}
+
+bool DFRobot_RTU_FileStorage::write(const uint8_t *data, uint16_t size){
+  char tmp[64];
+  FILE *fp = NULL;
+  bool ret = false;
+  if((data == NULL) || (_path == NULL) || (strlen(_path) + 5 > sizeof(tmp))) return false;
+  strcpy(tmp, _path);
+  strcat(tmp, ".tmp");
+  if((fp = fopen(tmp, "wb")) == NULL) return false;
+  ret = (fwrite(data, 1, size, fp) == size);
+  //The data must be on the disk before the rename, or a power cut can leave the new name on an empty file.
+  ret = ret && (fflush(fp) == 0) && (fsync(fileno(fp)) == 0);
+  ret = (fclose(fp) == 0) && ret;
+  //rename() replaces the old file atomically on Linux, some ESP32 file systems need it removed first.
+  if(ret && (rename(tmp, _path) != 0)){
+    remove(_path);
+    ret = (rename(tmp, _path) == 0);
+  }
+#if defined(__linux__)
+  //The rename itself is only durable once the directory is synced.
+  if(ret) ret = syncDir();
+#endif
+  return ret;
+}
+
+#if defined(__linux__)
+bool DFRobot_RTU_FileStorage::syncDir(){
+  char dir[64];
+  char *slash = NULL;
+  int fd = -1;
+  bool ret = false;
+  strcpy(dir, _path);
+  if((slash = strrchr(dir, '/')) == NULL){
+    strcpy(dir, ".");
+  }else if(slash == dir){
+    dir[1] = '\0';
+  }else{
+    *slash = '\0';
+  }
+  if((fd = open(dir, O_RDONLY | O_DIRECTORY)) < 0) return false;
+  ret = (fsync(fd) == 0);
+  close(fd);
+  return ret;
+}
+#endif
+#endif
@@ -0,0 +1,98 @@
+/*!
+ * @file DFRobot_RTU_Storage.h
+ * @brief Non-volatile storage of a binary blob, used by DFRobot_RTU_Topology. Implement DFRobot_RTU_Storage to use
+ * @n     another medium, the backends here are EEPROM(AVR, ESP8266, ESP32), NVS(ESP32) and a file(ESP32 VFS, Linux).
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#ifndef __DFRobot_RTU_STORAGE_H
+#define __DFRobot_RTU_STORAGE_H
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+class DFRobot_RTU_Storage{
+public:
+  virtual ~DFRobot_RTU_Storage(){}
+
+/**
+ * @brief Read the stored blob.
+ * @param data: Storage of the blob.
+ * @param size: Size of data.
+ * @return Number of bytes read, 0: nothing stored or error. The caller checks the content.
+ */
+  virtual uint16_t read(uint8_t *data, uint16_t size) = 0;
+
+/**
+ * @brief Replace the stored blob.
+ * @param data: The blob.
+ * @param size: Size of the blob.
+ * @return true: sucess, false: error.
+ */
+  virtual bool write(const uint8_t *data, uint16_t size) = 0;
+};
+
+#if defined(__AVR__) || defined(ESP8266) || defined(ESP32)
+class DFRobot_RTU_EEPROMStorage: public DFRobot_RTU_Storage{
+public:
+/**
+ * @brief DFRobot_RTU_EEPROMStorage constructor. Only changed bytes are written on AVR to save EEPROM cycles.
+ * @param address: Start address of the area in the EEPROM.
+ * @param size: Size of the area.
+ */
+  DFRobot_RTU_EEPROMStorage(uint16_t address = 0, uint16_t size = 512);
+  uint16_t read(uint8_t *data, uint16_t size);
+  bool write(const uint8_t *data, uint16_t size);
+
+private:
+  uint16_t _address;
+  uint16_t _size;
+};
+#endif
+
+#if defined(ESP32)
+class DFRobot_RTU_NVSStorage: public DFRobot_RTU_Storage{
+public:
+/**
+ * @brief DFRobot_RTU_NVSStorage constructor, the blob is a key of the ESP32 NVS(Preferences).
+ * @param ns: NVS namespace, at most 15 characters.
+ * @param key: Key of the blob, at most 15 characters.
+ */
+  DFRobot_RTU_NVSStorage(const char *ns = "rtu", const char *key = "topology");
+  uint16_t read(uint8_t *data, uint16_t size);
+  bool write(const uint8_t *data, uint16_t size);
+
+private:
+  const char *_ns;
+  const char *_key;
+};
+#endif
+
+#if defined(ESP32) || defined(__linux__)
+class DFRobot_RTU_FileStorage: public DFRobot_RTU_Storage{
+public:
+/**
+ * @brief DFRobot_RTU_FileStorage constructor. The blob is written to path + ".tmp", synced and renamed, on Linux
+ * @n     the directory is synced too, so a power cut leaves the old blob or the new one.
+ * @param path: File path, such as "/spiffs/rtu.bin" on ESP32 after SPIFFS.begin(), at most 60 characters.
+ */
+  DFRobot_RTU_FileStorage(const char *path);
+  uint16_t read(uint8_t *data, uint16_t size);
+  bool write(const uint8_t *data, uint16_t size);
+
+private:
+#if defined(__linux__)
+  bool syncDir();
+#endif
+  const char *_path;
+};
+#endif
+#endif
@@ -0,0 +1,193 @@
+/*!
+ * @file DFRobot_RTU_Topology.cpp
+ * @brief Persistent cache of the slaves on a bus.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#include <Arduino.h>
+#include "DFRobot_RTU_Topology.h"
+
+//Compiled out when a function code it needs is disabled in DFRobot_RTU_Config.h.
+#if RTU_ENABLE_FC11 && RTU_ENABLE_FC2B
+
+#if (RTU_TOPOLOGY_MAX_SLAVES < 1) || (RTU_TOPOLOGY_MAX_SLAVES > 247)
+#error "RTU_TOPOLOGY_MAX_SLAVES must be in range 1~247"
+#endif
+
+DFRobot_RTU_Topology::DFRobot_RTU_Topology(DFRobot_RTU *rtu, DFRobot_RTU_Storage *storage)
+  :_rtu(rtu), _storage(storage){
+  memset(&_blob, 0, sizeof(_blob));
+}
+
+bool DFRobot_RTU_Topology::begin(uint8_t first, uint8_t last){
+  if(load() && (verify() == 0)) return true;
+  discover(first, last);
+  save();
+  return false;
+}
+
+uint8_t DFRobot_RTU_Topology::discover(uint8_t first, uint8_t last){
+  sRtuTopologyEntry_t *entry = NULL;
+  sRtuTopologyEntry_t found;
+  _blob.header.count = 0;
+  if(_rtu == NULL) return 0;
+  for(uint16_t id = (first ? first : 1); (id <= last) && (id <= 0xF7); id++){
+    if(_blob.header.count >= RTU_TOPOLOGY_MAX_SLAVES) break;
+    entry = &_blob.entry[_blob.header.count];
+    //FC11 first, it is the cheapest request, an exception answer still proves the slave is there.
+    if(probe(id, eRTU_IDENTITY_NONE, entry) == (uint8_t)DFRobot_RTU::eRTU_RECV_ERROR) continue;
+    if(entry->source == eRTU_IDENTITY_NONE){
+      //A slave that ignores FC2B keeps the entry of the first probe, not the timeout as its reply time.
+      memcpy(&found, entry, sizeof(sRtuTopologyEntry_t));
+      if(probe(id, eRTU_IDENTITY_FC2B, entry) == (uint8_t)DFRobot_RTU::eRTU_RECV_ERROR){
+        memcpy(entry, &found, sizeof(sRtuTopologyEntry_t));
+      }
+    }
+    _blob.header.count++;
+  }
+  return _blob.header.count;
+}
+
+uint8_t DFRobot_RTU_Topology::verify(){
+  sRtuTopologyEntry_t entry;
+  uint32_t timeout = 0;
+  uint8_t ret = 0;
+  if((_rtu == NULL) || (_blob.header.count == 0)) return (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+  timeout = _rtu->getTimeoutTimeMs();
+  for(uint8_t i = 0; i < _blob.header.count; i++){
+    _rtu->setTimeoutTimeMs(getTimeout(_blob.entry[i].id));
+    ret = probe(_blob.entry[i].id, _blob.entry[i].source, &entry);
+    if(ret == (uint8_t)DFRobot_RTU::eRTU_RECV_ERROR) break;
+    ret = 0;
+    if((entry.source != _blob.entry[i].source) || (entry.identityLen != _blob.entry[i].identityLen) ||
+       (memcmp(entry.identity, _blob.entry[i].identity, entry.identityLen) != 0)){
+      ret = (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_DATA_VALUE;
+      break;
+    }
+    //Follow slow drifts of the reply time, one slow answer does not double the timeout.
+    _blob.entry[i].replyTime = (uint16_t)(((uint32_t)_blob.entry[i].replyTime * 3 + entry.replyTime + 3) / 4);
+  }
+  _rtu->setTimeoutTimeMs(timeout);
+  return ret;
+}
+
+bool DFRobot_RTU_Topology::load(){
+  sRtuTopologyBlob_t *blob = NULL;
+  uint16_t len = 0;
+  bool ret = false;
+  if(_storage == NULL) return false;
+  if((blob = (sRtuTopologyBlob_t *)malloc(sizeof(sRtuTopologyBlob_t))) == NULL){
+    RTU_DBG("Memory ERROR");
+    return false;
+  }
+  len = _storage->read((uint8_t *)blob, sizeof(sRtuTopologyBlob_t));
+  if((len >= sizeof(sRtuTopologyHeader_t)) && (blob->header.magic == RTU_TOPOLOGY_MAGIC) &&
+     (blob->header.version == RTU_TOPOLOGY_VERSION) && (blob->header.entrySize == sizeof(sRtuTopologyEntry_t)) &&
+     (blob->header.count <= RTU_TOPOLOGY_MAX_SLAVES) &&
+     (len >= sizeof(sRtuTopologyHeader_t) + blob->header.count * sizeof(sRtuTopologyEntry_t))){
+    memcpy(&_blob, blob, sizeof(sRtuTopologyHeader_t) + blob->header.count * sizeof(sRtuTopologyEntry_t));
+    if(blobCRC() == _blob.header.crc){
+      ret = true;
+    }else{
+      _blob.header.count = 0;
+    }
+  }
+  free(blob);
+  return ret;
+}
+
+bool DFRobot_RTU_Topology::save(){
+  if(_storage == NULL) return false;
+  _blob.header.magic = RTU_TOPOLOGY_MAGIC;
+  _blob.header.version = RTU_TOPOLOGY_VERSION;
+  _blob.header.entrySize = sizeof(sRtuTopologyEntry_t);
+  _blob.header.reserved = 0;
+  _blob.header.crc = blobCRC();
+  //Only the used entries are stored.
+  return _storage->write((uint8_t *)&_blob, sizeof(sRtuTopologyHeader_t) + _blob.header.count * sizeof(sRtuTopologyEntry_t));
+}
+
+uint8_t DFRobot_RTU_Topology::getCount(){
+  return _blob.header.count;
+}
+
+const DFRobot_RTU_Topology::sRtuTopologyEntry_t *DFRobot_RTU_Topology::getEntry(uint8_t index){
+  if(index >= _blob.header.count) return NULL;
+  return &_blob.entry[index];
+}
+
+const DFRobot_RTU_Topology::sRtuTopologyEntry_t *DFRobot_RTU_Topology::find(uint8_t id){
+  for(uint8_t i = 0; i < _blob.header.count; i++){
+    if(_blob.entry[i].id == id) return &_blob.entry[i];
+  }
+  return NULL;
+}
+
+uint32_t DFRobot_RTU_Topology::getTimeout(uint8_t id){
+  const sRtuTopologyEntry_t *entry = find(id);
+  if(entry == NULL) return (_rtu != NULL) ? _rtu->getTimeoutTimeMs() : 100;
+  return ((uint32_t)entry->replyTime * 2 + 9) / 10 + RTU_TOPOLOGY_TIMEOUT_MARGIN;
+}
+
+uint8_t DFRobot_RTU_Topology::probe(uint8_t id, uint8_t source, sRtuTopologyEntry_t *entry){
+  char value[RTU_TOPOLOGY_IDENTITY_SIZE + 1];
+  uint32_t start = 0, time = 0;
+  uint8_t ret = 0;
+  memset(entry, 0, sizeof(sRtuTopologyEntry_t));
+  entry->id = id;
+  start = micros();
+  if(source == eRTU_IDENTITY_FC2B){
+    ret = _rtu->readDeviceIdentification(id, /*objectId =*/0x01, value, sizeof(value));
+    if(ret == 0){
+      entry->identityLen = strlen(value);
+      memcpy(entry->identity, value, entry->identityLen);
+    }
+  }else{
+    //eRTU_IDENTITY_NONE is checked by FC11 too, the slave answers it with an exception.
+    entry->identityLen = RTU_TOPOLOGY_IDENTITY_SIZE;
+    ret = _rtu->reportServerID(id, entry->identity, &entry->identityLen);
+    if(ret != 0) entry->identityLen = 0;
+    if(source == eRTU_IDENTITY_NONE){
+      //Some slaves ignore FC11 instead of answering an exception, a cheap request tells them from an empty address.
+      //Only the answered request is timed.
+      if(ret == (uint8_t)DFRobot_RTU::eRTU_RECV_ERROR){
+        start = micros();
+        if(ping(id) != (uint8_t)DFRobot_RTU::eRTU_RECV_ERROR) ret = (uint8_t)DFRobot_RTU::eRTU_EXCEPTION_ILLEGAL_FUNCTION;
+      }
+      source = eRTU_IDENTITY_FC11;
+    }
+  }
+  time = (micros() - start + 99) / 100;
+  entry->replyTime = (time > 0xFFFF) ? 0xFFFF : time;
+  if(ret == 0) entry->source = source;
+  return ret;
+}
+
+uint8_t DFRobot_RTU_Topology::ping(uint8_t id){
+#if RTU_ENABLE_FC03
+  uint16_t value = 0;
+  return _rtu->readHoldingRegister(id, /*reg =*/0x0000, &value, /*regNum =*/1);
+#elif RTU_ENABLE_FC08
+  uint8_t data[2] = {0x52, 0x54};
+  return _rtu->echoDiagnostics(id, data, sizeof(data));
+#else
+  (void)id;
+  return (uint8_t)DFRobot_RTU::eRTU_RECV_ERROR;
+#endif
+}
+
+uint16_t DFRobot_RTU_Topology::blobCRC(){
+  uint8_t *data = (uint8_t *)_blob.entry;
+  uint16_t crc = 0xFFFF;
+  //Not swapped like calculateCRC(), caches saved before stay valid.
+  for(uint16_t i = 0; i < _blob.header.count * sizeof(sRtuTopologyEntry_t); i++){
+    crc = DFRobot_RTU::updateCRC(crc, data[i]);
+  }
+  return crc;
+}
+#endif
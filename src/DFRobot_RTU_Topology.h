@@ -0,0 +1,157 @@
+/*!
+ * @file DFRobot_RTU_Topology.h
+ * @brief Persistent cache of the slaves on a bus. Discovery finds the slaves, their identity(FC11 report server ID,
+ * @n     or FC2B ProductCode when FC11 is not supported) and their reply time, and stores them in a versioned binary
+ * @n     blob. After a reboot only the cached slaves are checked with their learned timeout, the whole address range
+ * @n     is scanned again only when the bus does not match the cache.
+ *
+ * @copyright   Copyright (c) 2010 DFRobot Co.Ltd (http://www.dfrobot.com)
+ * @licence     The MIT License (MIT)
+ * @author [Arya](xue.peng@dfrobot.com)
+ * @version  V1.0
+ * @date  2021-07-16
+ * @https://github.com/DFRobot/DFRobot_RTU
+ */
+#ifndef __DFRobot_RTU_TOPOLOGY_H
+#define __DFRobot_RTU_TOPOLOGY_H
+
+#include "DFRobot_RTU.h"
+#include "DFRobot_RTU_Storage.h"
+
+#ifndef RTU_TOPOLOGY_MAX_SLAVES
+#if defined(__AVR__)
+#define RTU_TOPOLOGY_MAX_SLAVES                    8    /**<Max number of cached slaves*/
+#else
+#define RTU_TOPOLOGY_MAX_SLAVES                    32   /**<Max number of cached slaves*/
+#endif
+#endif
+
+#ifndef RTU_TOPOLOGY_IDENTITY_SIZE
+#define RTU_TOPOLOGY_IDENTITY_SIZE                 16   /**<Bytes of the identity kept for every slave, longer ones are cut*/
+#endif
+
+#ifndef RTU_TOPOLOGY_TIMEOUT_MARGIN
+#define RTU_TOPOLOGY_TIMEOUT_MARGIN                10   /**<ms added to twice the learned reply time*/
+#endif
+
+#define RTU_TOPOLOGY_MAGIC                         0x5452 /**<"RT"*/
+#define RTU_TOPOLOGY_VERSION                       1    /**<Change it when sRtuTopologyEntry_t changes*/
+
+//Compiled out when a function code it needs is disabled in DFRobot_RTU_Config.h.
+#if RTU_ENABLE_FC11 && RTU_ENABLE_FC2B
+class DFRobot_RTU_Topology{
+public:
+typedef enum{
+  eRTU_IDENTITY_NONE = 0, /**<The slave supports neither FC11 nor FC2B, only its address is checked*/
+  eRTU_IDENTITY_FC11,     /**<Data of report server ID*/
+  eRTU_IDENTITY_FC2B      /**<ProductCode of read device identification*/
+}eRtuIdentitySource_t;
+
+typedef struct{
+  uint8_t id;
+  uint8_t source;                                 /**<eRtuIdentitySource_t*/
+  uint16_t replyTime;                             /**<Learned time from the request to the end of the answer, unit 100us*/
+  uint8_t identityLen;
+  uint8_t identity[RTU_TOPOLOGY_IDENTITY_SIZE];
+}__attribute__ ((packed)) sRtuTopologyEntry_t;
+
+/**
+ * @brief DFRobot_RTU_Topology constructor.
+ * @param rtu:  The modbus master of the bus.
+ * @param storage: Where the cache is kept, such as a DFRobot_RTU_EEPROMStorage. NULL: no persistence.
+ */
+  DFRobot_RTU_Topology(DFRobot_RTU *rtu, DFRobot_RTU_Storage *storage);
+  ~DFRobot_RTU_Topology(){}
+
+/**
+ * @brief Cold start: load the cache and verify it, run discover() and save the result when it does not match.
+ * @param first: First address of the discovery range.
+ * @param last: Last address of the discovery range.
+ * @return true: The cache matched the bus, false: The bus was discovered again.
+ */
+  bool begin(uint8_t first = 0x01, uint8_t last = 0xF7);
+
+/**
+ * @brief Scan the address range and replace the slaves in RAM. An address that does not answer FC11 is checked
+ * @n     again with FC03 of one register(or the FC08 echo), so every absent address costs twice the timeout of the
+ * @n     master, set a short one by setTimeoutTimeMs() before.
+ * @param first: First address.
+ * @param last: Last address.
+ * @return Number of slaves found, at most RTU_TOPOLOGY_MAX_SLAVES.
+ */
+  uint8_t discover(uint8_t first = 0x01, uint8_t last = 0xF7);
+
+/**
+ * @brief Ask every slave in RAM for its identity again, with the timeout learned for it. The reply times are updated
+ * @n     in RAM, call save() to keep them.
+ * @return Exception code:
+ * @n      0 : Every slave answered with the same identity.
+ * @n      3 or eRTU_EXCEPTION_ILLEGAL_DATA_VALUE: An identity differs, or no slave is cached.
+ * @n      9 or eRTU_RECV_ERROR: A slave did not answer.
+ */
+  uint8_t verify();
+
+/**
+ * @brief Load the cache from the storage to RAM, a blob of another version or with a wrong CRC is refused.
+ * @return true: sucess, false: no valid cache, nothing is changed.
+ */
+  bool load();
+
+/**
+ * @brief Save the slaves in RAM to the storage.
+ * @return true: sucess, false: no storage or write error.
+ */
+  bool save();
+
+/**
+ * @brief Get the slaves in RAM.
+ * @param index: 0 ~ getCount() - 1.
+ * @return The slave, NULL: index out of range.
+ */
+  uint8_t getCount();
+  const sRtuTopologyEntry_t *getEntry(uint8_t index);
+
+/**
+ * @brief Find a slave by address.
+ * @param id:  modbus device ID.
+ * @return The slave, NULL: not cached.
+ */
+  const sRtuTopologyEntry_t *find(uint8_t id);
+
+/**
+ * @brief Timeout for a slave from its learned reply time, for setTimeoutTimeMs().
+ * @param id:  modbus device ID.
+ * @return Twice the reply time plus RTU_TOPOLOGY_TIMEOUT_MARGIN, unit ms. The timeout of the master if not cached.
+ */
+  uint32_t getTimeout(uint8_t id);
+
+protected:
+  uint8_t probe(uint8_t id, uint8_t source, sRtuTopologyEntry_t *entry);
+/**
+ * @brief Whether anything answers at an address, FC03 of one register, or the FC08 echo when FC03 is disabled.
+ * @return eRTU_RECV_ERROR: No answer, any other value: the slave is there.
+ */
+  uint8_t ping(uint8_t id);
+  uint16_t blobCRC();
+
+private:
+typedef struct{
+  uint16_t magic;
+  uint8_t version;
+  uint8_t entrySize;
+  uint8_t count;
+  uint8_t reserved;
+  uint16_t crc;                                   /**<CRC of the entries*/
+}__attribute__ ((packed)) sRtuTopologyHeader_t;
+
+typedef struct{
+  sRtuTopologyHeader_t header;
+  sRtuTopologyEntry_t entry[RTU_TOPOLOGY_MAX_SLAVES];
+}__attribute__ ((packed)) sRtuTopologyBlob_t;
+
+  DFRobot_RTU *_rtu;
+  DFRobot_RTU_Storage *_storage;
+  sRtuTopologyBlob_t _blob;
+};
+#endif
+#endif